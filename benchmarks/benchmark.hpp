@@ -0,0 +1,57 @@
+#pragma once
+
+#include "algorithm.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace IDragnev::Benchmark
+{
+	//the best of a few runs is the least disturbed by other work on the machine.
+	//Each run takes a fresh input from prepare, which is not timed
+	template <typename Prepare, typename Run>
+	double bestSeconds(Prepare prepare, Run run, int repetitions = 5)
+	{
+		auto best = std::chrono::duration<double>::max();
+
+		for (auto i = 0; i < repetitions; ++i)
+		{
+			auto input = prepare();
+			const auto start = std::chrono::steady_clock::now();
+			run(input);
+			const auto time = std::chrono::duration<double>{ std::chrono::steady_clock::now() - start };
+
+			best = std::min(best, time);
+		}
+
+		return best.count();
+	}
+
+	inline void report(const std::string& name, std::size_t count, double seconds)
+	{
+		std::printf("%-52s %12zu items %10.2f ms %8.2f ns/item\n", name.c_str(), count, seconds * 1e3, seconds * 1e9 / count);
+	}
+
+	template <typename Key>
+	std::vector<Key> randomKeys(std::size_t count, std::uint64_t seed = 42)
+	{
+		auto engine = std::mt19937_64{ seed };
+		auto keys = std::vector<Key>(count);
+
+		for (auto& key : keys)
+		{
+			key = static_cast<Key>(engine());
+		}
+
+		return keys;
+	}
+
+	//the first argument of a benchmark overrides its default count of items
+	inline std::size_t countFrom(int argc, char* argv[], std::size_t defaultCount)
+	{
+		return (argc > 1) ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : defaultCount;
+	}
+}
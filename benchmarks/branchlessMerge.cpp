@@ -0,0 +1,50 @@
+//MergeSorter on shuffled keys, with the branchless merge taken for std::less
+//against the branching one taken for a lambda doing the same comparison
+#include "benchmark.hpp"
+
+namespace alg = IDragnev::Algorithm;
+namespace bench = IDragnev::Benchmark;
+
+//not the default leaf sorter, so neither sort takes the network leaves
+//and the two differ only in their merges
+struct InsertionLeaves
+{
+	template <typename RandomAccessIt, typename CompareFn>
+	void operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) const
+	{
+		alg::InsertionSorter{}(first, last, lessThan);
+	}
+};
+
+template <typename Key>
+void compareMerges(const std::string& keyName, std::size_t count)
+{
+	using Keys = std::vector<Key>;
+
+	const auto keys = bench::randomKeys<Key>(count);
+	const auto copyKeys = [&keys]() { return keys; };
+
+	auto sorter = alg::MergeSorter<typename Keys::iterator, 25, 0, InsertionLeaves>{};
+	//a single thread, so the merges are not hidden behind the pool
+	sorter.setParallelGrain(count);
+
+	const auto branchless = bench::bestSeconds(copyKeys, [&sorter](Keys& keys)
+	{
+		sorter(std::begin(keys), std::end(keys), std::less<>{});
+	});
+	const auto branching = bench::bestSeconds(copyKeys, [&sorter](Keys& keys)
+	{
+		sorter(std::begin(keys), std::end(keys), [](Key x, Key y) { return x < y; });
+	});
+
+	bench::report(keyName + " keys, branchless merge", count, branchless);
+	bench::report(keyName + " keys, branching merge", count, branching);
+}
+
+int main(int argc, char* argv[])
+{
+	const auto count = bench::countFrom(argc, argv, 10'000'000);
+
+	compareMerges<std::uint32_t>("32 bit", count);
+	compareMerges<std::uint64_t>("64 bit", count);
+}
@@ -0,0 +1,61 @@
+//64 bit keys are pushed one by one into a heap and then popped until it is
+//empty, by DaryHeap with 2, 4 and 8 children per item and by std::priority_queue.
+//Sizes grow by 8 from 1K up to the count of items
+#include "benchmark.hpp"
+#include <queue>
+
+namespace alg = IDragnev::Algorithm;
+namespace bench = IDragnev::Benchmark;
+
+using Keys = std::vector<std::uint64_t>;
+
+//keeps the popped keys from being optimised away
+volatile std::uint64_t sink = 0;
+
+template <typename Heap>
+double timeHeap(const Keys& keys)
+{
+	return bench::bestSeconds([]() { return 0; }, [&](int)
+	{
+		auto heap = Heap{};
+		auto sum = std::uint64_t{ 0 };
+
+		for (auto key : keys)
+		{
+			heap.push(key);
+		}
+
+		if constexpr (std::is_same_v<Heap, std::priority_queue<std::uint64_t>>)
+		{
+			for (; !heap.empty(); heap.pop())
+			{
+				sum += heap.top();
+			}
+		}
+		else
+		{
+			while (!heap.isEmpty())
+			{
+				sum += heap.pop();
+			}
+		}
+
+		sink = sum;
+	});
+}
+
+int main(int argc, char* argv[])
+{
+	const auto maxLength = bench::countFrom(argc, argv, 4'000'000);
+
+	for (auto length = std::size_t{ 1'000 }; length <= maxLength; length *= 8)
+	{
+		const auto keys = bench::randomKeys<std::uint64_t>(length);
+		const auto size = std::to_string(length);
+
+		bench::report("std::priority_queue, " + size, length, timeHeap<std::priority_queue<std::uint64_t>>(keys));
+		bench::report("DaryHeap<2>, " + size, length, timeHeap<alg::DaryHeap<std::uint64_t, 2>>(keys));
+		bench::report("DaryHeap<4>, " + size, length, timeHeap<alg::DaryHeap<std::uint64_t, 4>>(keys));
+		bench::report("DaryHeap<8>, " + size, length, timeHeap<alg::DaryHeap<std::uint64_t, 8>>(keys));
+	}
+}
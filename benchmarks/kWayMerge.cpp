@@ -0,0 +1,79 @@
+//kWayMerge of k sorted shards against merging them in rounds of two-way
+//merges, where each round halves the count of shards
+#include "benchmark.hpp"
+
+namespace alg = IDragnev::Algorithm;
+namespace bench = IDragnev::Benchmark;
+
+using Keys = std::vector<std::uint64_t>;
+
+std::vector<Keys> makeShards(std::size_t k, std::size_t count)
+{
+	const auto keys = bench::randomKeys<std::uint64_t>(count);
+	auto shards = std::vector<Keys>(k);
+
+	for (auto i = std::size_t{ 0 }; i < count; ++i)
+	{
+		shards[i % k].push_back(keys[i]);
+	}
+
+	for (auto& shard : shards)
+	{
+		std::sort(std::begin(shard), std::end(shard));
+	}
+
+	return shards;
+}
+
+void mergeInRounds(std::vector<Keys>& shards)
+{
+	while (shards.size() > 1)
+	{
+		auto merged = std::vector<Keys>{};
+
+		for (auto i = std::size_t{ 0 }; i < shards.size(); i += 2)
+		{
+			if (i + 1 == shards.size())
+			{
+				merged.push_back(std::move(shards[i]));
+			}
+			else
+			{
+				auto result = Keys(shards[i].size() + shards[i + 1].size());
+				std::merge(std::cbegin(shards[i]), std::cend(shards[i]), std::cbegin(shards[i + 1]), std::cend(shards[i + 1]), std::begin(result));
+				merged.push_back(std::move(result));
+			}
+		}
+
+		shards = std::move(merged);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const auto count = bench::countFrom(argc, argv, 10'000'000);
+
+	for (auto k : { 2, 3, 4, 8, 16, 64, 256 })
+	{
+		const auto shards = makeShards(k, count);
+		const auto copyShards = [&shards]() { return shards; };
+
+		const auto kWay = bench::bestSeconds(copyShards, [count](std::vector<Keys>& shards)
+		{
+			using Range = std::pair<Keys::const_iterator, Keys::const_iterator>;
+
+			auto ranges = std::vector<Range>{};
+			for (auto& shard : shards)
+			{
+				ranges.emplace_back(std::cbegin(shard), std::cend(shard));
+			}
+
+			auto result = Keys(count);
+			alg::kWayMerge(std::cbegin(ranges), std::cend(ranges), std::begin(result));
+		});
+		const auto inRounds = bench::bestSeconds(copyShards, mergeInRounds);
+
+		bench::report("k = " + std::to_string(k) + ", kWayMerge", count, kWay);
+		bench::report("k = " + std::to_string(k) + ", two-way merges in rounds", count, inRounds);
+	}
+}
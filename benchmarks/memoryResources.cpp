@@ -0,0 +1,63 @@
+//32 threads each sort a series of requests with MergeSorter, taking scratch memory
+//from the default heap, from a monotonic arena of their own which is reset after
+//each request or from a pool of their own
+#include "benchmark.hpp"
+#include <memory_resource>
+#include <thread>
+
+namespace alg = IDragnev::Algorithm;
+namespace bench = IDragnev::Benchmark;
+
+enum class Resource { heap, monotonic, pool };
+
+double timeRequests(Resource resource, std::size_t threadsCount, std::size_t requestsCount, const std::vector<std::uint64_t>& keys)
+{
+	using Keys = std::vector<std::uint64_t>;
+
+	return bench::bestSeconds([]() { return 0; }, [&](int)
+	{
+		auto threads = std::vector<std::thread>{};
+
+		for (auto i = std::size_t{ 0 }; i < threadsCount; ++i)
+		{
+			threads.emplace_back([&]()
+			{
+				auto arena = std::pmr::monotonic_buffer_resource{ keys.size() * sizeof(std::uint64_t) };
+				auto pool = std::pmr::unsynchronized_pool_resource{};
+				auto items = keys;
+
+				auto sorter = alg::MergeSorter<Keys::iterator>{};
+				//the requests run in parallel with each other, not within themselves
+				sorter.setParallelGrain(keys.size());
+				sorter.setMemoryResource((resource == Resource::monotonic) ? static_cast<std::pmr::memory_resource*>(&arena) :
+										 (resource == Resource::pool) ? &pool : nullptr);
+
+				for (auto request = std::size_t{ 0 }; request < requestsCount; ++request)
+				{
+					std::copy(std::cbegin(keys), std::cend(keys), std::begin(items));
+					sorter(std::begin(items), std::end(items));
+					arena.release();
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}, 3);
+}
+
+int main(int argc, char* argv[])
+{
+	constexpr auto threadsCount = std::size_t{ 32 };
+	constexpr auto requestsCount = std::size_t{ 20 };
+
+	const auto length = bench::countFrom(argc, argv, 100'000);
+	const auto keys = bench::randomKeys<std::uint64_t>(length);
+	const auto items = threadsCount * requestsCount * length;
+
+	bench::report("default heap", items, timeRequests(Resource::heap, threadsCount, requestsCount, keys));
+	bench::report("monotonic arena per thread", items, timeRequests(Resource::monotonic, threadsCount, requestsCount, keys));
+	bench::report("pool per thread", items, timeRequests(Resource::pool, threadsCount, requestsCount, keys));
+}
@@ -0,0 +1,28 @@
+//RadixSorter sorts 64 bit keys with one thread and up to twice the cores of
+//the machine, the calling thread and the rest from a pool. Past the count of
+//cores the threads only take turns
+#include "benchmark.hpp"
+#include <thread>
+
+namespace alg = IDragnev::Algorithm;
+namespace bench = IDragnev::Benchmark;
+
+int main(int argc, char* argv[])
+{
+	using Keys = std::vector<std::uint64_t>;
+
+	const auto length = bench::countFrom(argc, argv, 20'000'000);
+	const auto keys = bench::randomKeys<std::uint64_t>(length);
+	const auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+	auto pool = alg::ThreadPool{ 2 * cores - 1 };
+	std::printf("%u cores\n", cores);
+
+	for (auto threads = std::size_t{ 1 }; threads <= 2 * cores; threads *= 2)
+	{
+		const auto sorter = alg::RadixSorter<>{ pool, threads };
+		const auto seconds = bench::bestSeconds([&]() { return keys; }, [&](Keys& items) { sorter(std::begin(items), std::end(items)); }, 3);
+
+		bench::report("threads: " + std::to_string(threads), length, seconds);
+	}
+}
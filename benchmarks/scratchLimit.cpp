@@ -0,0 +1,62 @@
+//MergeSorter sorts 64 bit keys with scratch buffers from the whole length of
+//the input down to none. The peak of scratch memory is taken from a resource
+//which counts the bytes it hands out
+#include "benchmark.hpp"
+#include <memory_resource>
+
+namespace alg = IDragnev::Algorithm;
+namespace bench = IDragnev::Benchmark;
+
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	std::size_t getPeak() const noexcept { return peak; }
+
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override
+	{
+		auto result = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		current += bytes;
+		peak = std::max(peak, current);
+
+		return result;
+	}
+
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+	{
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		current -= bytes;
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+	std::size_t current = 0;
+	std::size_t peak = 0;
+};
+
+int main(int argc, char* argv[])
+{
+	using Keys = std::vector<std::uint64_t>;
+
+	const auto length = bench::countFrom(argc, argv, 4'000'000);
+	const auto keys = bench::randomKeys<std::uint64_t>(length);
+
+	for (auto divisor : { 1, 4, 16, 256, 4096, 0 })
+	{
+		const auto limit = (divisor > 0) ? length / divisor : 0;
+		auto resource = CountingResource{};
+
+		auto sorter = alg::MergeSorter<Keys::iterator>{};
+		sorter.setParallelGrain(length);
+		sorter.setMemoryResource(&resource);
+		sorter.setScratchLimit(limit);
+
+		const auto seconds = bench::bestSeconds([&]() { return keys; }, [&](Keys& items) { sorter(std::begin(items), std::end(items)); }, 3);
+		const auto name = "limit of " + std::to_string(limit) + " items, peak " + std::to_string(resource.getPeak() / 1024) + " KiB";
+
+		bench::report(name, length, seconds);
+	}
+}
@@ -0,0 +1,99 @@
+//StringSorter against MergeSorter and std::sort on generated URLs and file paths.
+//Both corpora have long shared prefixes: a few hosts and top directories take
+//most of the keys, the rest is made of words from a small vocabulary
+#include "benchmark.hpp"
+
+namespace alg = IDragnev::Algorithm;
+namespace bench = IDragnev::Benchmark;
+
+using Strings = std::vector<std::string>;
+
+class Corpus
+{
+public:
+	explicit Corpus(std::uint64_t seed) : engine{ seed }
+	{
+		for (auto i = 0; i < 2'000; ++i)
+		{
+			auto word = std::string(3 + engine() % 8, ' ');
+			for (auto& character : word)
+			{
+				character = static_cast<char>('a' + engine() % 26);
+			}
+
+			words.push_back(std::move(word));
+		}
+	}
+
+	Strings urls(std::size_t count)
+	{
+		auto result = Strings(count);
+
+		for (auto& url : result)
+		{
+			url = "https://www." + skewedWord(200) + ".com";
+			for (auto segments = 1 + engine() % 5; segments > 0; --segments)
+			{
+				url += '/';
+				url += skewedWord(words.size());
+			}
+
+			if (engine() % 2 == 0)
+			{
+				url += "?id=" + std::to_string(engine() % 1'000'000);
+			}
+		}
+
+		return result;
+	}
+
+	Strings paths(std::size_t count)
+	{
+		static const auto roots = Strings{ "/usr/lib/x86_64-linux-gnu/", "/usr/share/doc/", "/home/user/projects/", "/var/lib/", "/opt/" };
+		static const auto extensions = Strings{ ".cpp", ".hpp", ".txt", ".so", ".json", ".md" };
+		auto result = Strings(count);
+
+		for (auto& path : result)
+		{
+			path = roots[engine() % roots.size()];
+			for (auto directories = 1 + engine() % 6; directories > 0; --directories)
+			{
+				path += skewedWord(50 * directories);
+				path += '/';
+			}
+
+			path += words[engine() % words.size()] + extensions[engine() % extensions.size()];
+		}
+
+		return result;
+	}
+
+private:
+	//the square of a uniform fraction favours the first words
+	const std::string& skewedWord(std::size_t range)
+	{
+		const auto fraction = static_cast<double>(engine() % 1'000'000) / 1'000'000;
+		return words[static_cast<std::size_t>(fraction * fraction * std::min(range, words.size()))];
+	}
+
+	std::mt19937_64 engine;
+	Strings words;
+};
+
+void compare(const std::string& corpus, const Strings& keys)
+{
+	auto prepare = [&keys]() { return keys; };
+
+	bench::report("StringSorter, " + corpus, keys.size(), bench::bestSeconds(prepare, [](Strings& items) { alg::StringSorter{}(std::begin(items), std::end(items)); }, 3));
+	bench::report("MergeSorter, " + corpus, keys.size(), bench::bestSeconds(prepare, [](Strings& items) { alg::MergeSorter<Strings::iterator>{}(std::begin(items), std::end(items)); }, 3));
+	bench::report("std::sort, " + corpus, keys.size(), bench::bestSeconds(prepare, [](Strings& items) { std::sort(std::begin(items), std::end(items)); }, 3));
+}
+
+int main(int argc, char* argv[])
+{
+	const auto count = bench::countFrom(argc, argv, 2'000'000);
+	auto corpus = Corpus{ 42 };
+
+	compare("URLs", corpus.urls(count));
+	compare("paths", corpus.paths(count));
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <numeric>
+#include <limits>
+#include <stdexcept>
+
+namespace IDragnev::Algorithm
+{
+	namespace Detail
+	{
+		template <typename Index, typename RandomAccessIt, typename CompareFn, typename Sorter>
+		std::vector<Index> argsort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan, Sorter&& sorter)
+		{
+			static_assert(std::is_integral_v<Index> && std::is_unsigned_v<Index>, "Indices must be of an unsigned integral type");
+
+			const auto length = static_cast<std::uintmax_t>(std::distance(first, last));
+			if (length > std::numeric_limits<Index>::max())
+			{
+				throw std::length_error{ "The range is too long for the index type" };
+			}
+
+			auto indices = std::vector<Index>(static_cast<std::size_t>(length));
+			std::iota(std::begin(indices), std::end(indices), Index{ 0 });
+
+			//the data of an empty vector may be null, which the sorters cannot step back from
+			if (length < 2)
+			{
+				return indices;
+			}
+
+			auto data = indices.data();
+			sorter(data, data + indices.size(), [first, lessThan](Index lhs, Index rhs) 
+			{
+				return lessThan(first[lhs], first[rhs]); 
+			});
+
+			return indices;
+		}
+	}
+
+	template <typename Index, typename RandomAccessIt, typename CompareFn>
+	std::vector<Index> argsort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		auto sorter = MergeSorter<Index*>{};
+		sorter.setParallelGrain(std::numeric_limits<std::size_t>::max());
+
+		return Detail::argsort<Index>(first, last, lessThan, sorter);
+	}
+
+	template <typename Index, typename RandomAccessIt, typename CompareFn>
+	std::vector<Index> unstableArgsort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		return Detail::argsort<Index>(first, last, lessThan, QuickSorter{});
+	}
+
+	template <typename Index, typename RandomAccessIt, typename CompareFn>
+	std::vector<Index> parallelArgsort(RandomAccessIt first, RandomAccessIt last, ThreadPool& pool, CompareFn lessThan)
+	{
+		return Detail::argsort<Index>(first, last, lessThan, MergeSorter<Index*>{ pool });
+	}
+
+	template <typename RandomAccessIt, typename Index>
+	void applyPermutation(RandomAccessIt first, std::vector<Index> permutation)
+	{
+		const auto length = permutation.size();
+
+		for (auto start = std::size_t{ 0 }; start < length; ++start)
+		{
+			if (permutation[start] == start)
+			{
+				continue;
+			}
+
+			//every visited position is marked as fixed
+			auto item = std::move(first[start]);
+			auto current = start;
+
+			for (auto next = static_cast<std::size_t>(permutation[current]); 
+				 next != start;
+				 next = static_cast<std::size_t>(permutation[current]))
+			{
+				first[current] = std::move(first[next]);
+				permutation[current] = static_cast<Index>(current);
+				current = next;
+			}
+
+			first[current] = std::move(item);
+			permutation[current] = static_cast<Index>(current);
+		}
+	}
+}
@@ -0,0 +1,363 @@
+#pragma once
+
+#include <stdexcept>
+
+namespace IDragnev::Algorithm
+{
+	namespace Detail
+	{
+		//an unsigned key which orders like the given integral or enumeration one
+		template <typename Key>
+		auto toCountingKey(Key key) noexcept
+		{
+			if constexpr (std::is_enum_v<Key>)
+			{
+				return toRadixKey(static_cast<std::underlying_type_t<Key>>(key));
+			}
+			else
+			{
+				static_assert(std::is_integral_v<Key>, "Counting keys must be of an integral or enumeration type");
+				return toRadixKey(key);
+			}
+		}
+	}
+
+	inline CountingSorter::CountingSorter(ThreadPool& pool, std::size_t threadsCount) noexcept :
+		pool(&pool),
+		threadsCount(threadsCount)
+	{
+	}
+
+	template <typename RandomAccessIt, typename KeyFn>
+	void CountingSorter::operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf) const
+	{
+		if (first == last)
+		{
+			return;
+		}
+
+		using CountingKey = decltype(Detail::toCountingKey(keyOf(*first)));
+
+		const auto size = static_cast<std::size_t>(std::distance(first, last));
+		const auto threads = threadsFor(size);
+
+		//each thread finds the range of the keys in its chunk
+		auto ranges = std::pmr::vector<std::pair<CountingKey, CountingKey>>(threads, getMemoryResource());
+		forEachChunk(threads, [&](std::size_t thread)
+		{
+			auto current = std::next(first, size * thread / threads);
+			auto chunkLast = std::next(first, size * (thread + 1) / threads);
+			auto minKey = Detail::toCountingKey(keyOf(*current));
+			auto maxKey = minKey;
+
+			for (++current; current != chunkLast; ++current)
+			{
+				auto key = Detail::toCountingKey(keyOf(*current));
+				minKey = std::min(minKey, key);
+				maxKey = std::max(maxKey, key);
+			}
+
+			ranges[thread] = { minKey, maxKey };
+		});
+
+		auto [minKey, maxKey] = ranges.front();
+		for (const auto& [low, high] : ranges)
+		{
+			minKey = std::min(minKey, low);
+			maxKey = std::max(maxKey, high);
+		}
+
+		sortInRange(first, last, keyOf, minKey, maxKey);
+	}
+
+	template <typename RandomAccessIt, typename KeyFn, typename Key>
+	void CountingSorter::operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf, Key minKey, Key maxKey) const
+	{
+		using ItemKey = std::decay_t<decltype(keyOf(*first))>;
+
+		auto low = Detail::toCountingKey(static_cast<ItemKey>(minKey));
+		auto high = Detail::toCountingKey(static_cast<ItemKey>(maxKey));
+
+		if (high < low)
+		{
+			throw std::invalid_argument{ "The minimum key must not be greater than the maximum one" };
+		}
+
+		//counting checks the keys as it goes, the radix sort
+		//and ranges too short to sort do not
+		if (auto size = static_cast<std::size_t>(std::distance(first, last));
+			size < 2 || !isSuitable(size, low, high))
+		{
+			checkKeys(first, last, keyOf, low, high);
+		}
+
+		sortInRange(first, last, keyOf, low, high);
+	}
+
+	//the counts are summed up in a pass over them, which costs about
+	//as much as the items do when there are as many keys as items
+	template <typename Key>
+	bool CountingSorter::isSuitable(std::size_t length, Key minKey, Key maxKey) noexcept
+	{
+		auto low = Detail::toCountingKey(minKey);
+		auto high = Detail::toCountingKey(maxKey);
+
+		if (high < low)
+		{
+			return false;
+		}
+
+		//the count of keys itself overflows for the full range of 64 bit keys
+		auto span = static_cast<std::uint64_t>(high - low);
+
+		return span < maxKeysCount && span < length;
+	}
+
+	inline void CountingSorter::setMemoryResource(std::pmr::memory_resource* resource) noexcept
+	{
+		this->resource = resource;
+	}
+
+	inline std::pmr::memory_resource* CountingSorter::getMemoryResource() const noexcept
+	{
+		return (resource != nullptr) ? resource : std::pmr::get_default_resource();
+	}
+
+	inline void CountingSorter::setThreadsCount(std::size_t count) noexcept
+	{
+		threadsCount = count;
+	}
+
+	inline std::size_t CountingSorter::getThreadsCount() const noexcept
+	{
+		return threadsCount;
+	}
+
+	inline ThreadPool& CountingSorter::threadPool() const
+	{
+		return (pool != nullptr) ? *pool : ThreadPool::shared();
+	}
+
+	inline std::size_t CountingSorter::threadsFor(std::size_t length) const
+	{
+		auto threads = (threadsCount > 0) ? threadsCount : threadPool().workersCount() + 1;
+		return std::max(std::min(threads, length / minChunkLength), std::size_t{ 1 });
+	}
+
+	template <typename Callable>
+	inline void CountingSorter::forEachChunk(std::size_t threads, Callable f) const
+	{
+		if (threads == 1)
+		{
+			f(std::size_t{ 0 });
+		}
+		else
+		{
+			threadPool().forEachIndex(threads, f);
+		}
+	}
+
+	template <typename RandomAccessIt, typename KeyFn, typename CountingKey>
+	void CountingSorter::sortInRange(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf, CountingKey minKey, CountingKey maxKey) const
+	{
+		const auto size = static_cast<std::size_t>(std::distance(first, last));
+		if (size < 2)
+		{
+			return;
+		}
+		else if (!isSuitable(size, minKey, maxKey))
+		{
+			sortByRadix(first, last, keyOf);
+			return;
+		}
+
+		//keys below the minimum wrap around past the maximum
+		auto indexOf = [keyOf, minKey](const auto& item)
+		{
+			return static_cast<std::size_t>(static_cast<CountingKey>(Detail::toCountingKey(keyOf(item)) - minKey));
+		};
+		//suitable ranges have less than maxKeysCount keys, so this does not overflow
+		const auto keysCount = static_cast<std::size_t>(maxKey - minKey) + 1;
+
+		if constexpr (isContiguousIterator<RandomAccessIt>)
+		{
+			auto items = std::addressof(*first);
+			sort(items, items + size, indexOf, keysCount);
+		}
+		else
+		{
+			sort(first, last, indexOf, keysCount);
+		}
+	}
+
+	template <typename RandomAccessIt, typename KeyFn, typename CountingKey>
+	void CountingSorter::checkKeys(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf, CountingKey minKey, CountingKey maxKey) const
+	{
+		const auto size = static_cast<std::size_t>(std::distance(first, last));
+		const auto threads = threadsFor(size);
+
+		forEachChunk(threads, [&](std::size_t thread)
+		{
+			for (auto i = size * thread / threads; i < size * (thread + 1) / threads; ++i)
+			{
+				if (auto key = Detail::toCountingKey(keyOf(first[i]));
+					key < minKey || maxKey < key)
+				{
+					throw std::out_of_range{ "A key is out of the given range" };
+				}
+			}
+		});
+	}
+
+	template <typename RandomAccessIt, typename IndexFn>
+	void CountingSorter::sort(RandomAccessIt first, RandomAccessIt last, IndexFn indexOf, std::size_t keysCount) const
+	{
+		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
+
+		const auto size = static_cast<std::size_t>(std::distance(first, last));
+		const auto threads = threadsFor(size);
+
+		//each thread counts the keys of its chunk into its own histogram
+		auto offsets = std::pmr::vector<std::size_t>(threads * keysCount, 0, getMemoryResource());
+		forEachChunk(threads, [&](std::size_t thread)
+		{
+			auto counts = offsets.data() + thread * keysCount;
+
+			for (auto i = size * thread / threads; i < size * (thread + 1) / threads; ++i)
+			{
+				auto index = indexOf(first[i]);
+				if (index >= keysCount)
+				{
+					throw std::out_of_range{ "A key is out of the given range" };
+				}
+
+				++counts[index];
+			}
+		});
+
+		//a key shared by all items leaves the order as it is
+		const auto firstIndex = indexOf(*first);
+		auto firstKeyCount = std::size_t{ 0 };
+		for (auto thread = std::size_t{ 0 }; thread < threads; ++thread)
+		{
+			firstKeyCount += offsets[thread * keysCount + firstIndex];
+		}
+
+		if (firstKeyCount == size)
+		{
+			return;
+		}
+
+		//the items of a key go in the order of the chunks, which keeps the sort stable
+		for (auto index = std::size_t{ 0 }, sum = std::size_t{ 0 }; index < keysCount; ++index)
+		{
+			for (auto thread = std::size_t{ 0 }; thread < threads; ++thread)
+			{
+				auto& offset = offsets[thread * keysCount + index];
+				auto count = offset;
+				offset = sum;
+				sum += count;
+			}
+		}
+
+		if constexpr (sizeof(Item) <= recordBytes && std::is_nothrow_move_constructible_v<Item> && std::is_nothrow_move_assignable_v<Item>)
+		{
+			moveThroughBuffer(first, size, threads, offsets.data(), keysCount, indexOf);
+		}
+		else if (size <= std::numeric_limits<std::uint32_t>::max())
+		{
+			moveByPermutation<std::uint32_t>(first, size, threads, offsets.data(), keysCount, indexOf);
+		}
+		else
+		{
+			moveByPermutation<std::size_t>(first, size, threads, offsets.data(), keysCount, indexOf);
+		}
+	}
+
+	template <typename RandomAccessIt, typename IndexFn>
+	void CountingSorter::moveThroughBuffer(RandomAccessIt first, std::size_t size, std::size_t threads, std::size_t* offsets, std::size_t keysCount, IndexFn indexOf) const
+	{
+		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
+
+		auto source = getMemoryResource();
+		auto buffer = static_cast<Item*>(source->allocate(size * sizeof(Item), alignof(Item)));
+		auto isBufferConstructed = false;
+		auto x = CallOnDestruction{ [source, buffer, size, &isBufferConstructed]() noexcept
+		{
+			if (isBufferConstructed)
+			{
+				std::destroy(buffer, buffer + size);
+			}
+
+			source->deallocate(buffer, size * sizeof(Item), alignof(Item));
+		} };
+
+		//the items of each chunk and key are constructed from where their offset starts,
+		//so the ones to destroy are known when a key throws partway through
+		auto starts = std::pmr::vector<std::size_t>(getMemoryResource());
+		if constexpr (!std::is_trivially_destructible_v<Item>)
+		{
+			starts.assign(offsets, offsets + threads * keysCount);
+		}
+
+		try
+		{
+			forEachChunk(threads, [&](std::size_t thread)
+			{
+				auto chunkOffsets = offsets + thread * keysCount;
+
+				for (auto i = size * thread / threads; i < size * (thread + 1) / threads; ++i)
+				{
+					auto& position = chunkOffsets[indexOf(first[i])];
+					::new (static_cast<void*>(buffer + position)) Item(std::move(first[i]));
+					++position;
+				}
+			});
+		}
+		catch (...)
+		{
+			for (auto i = std::size_t{ 0 }; i < starts.size(); ++i)
+			{
+				std::destroy(buffer + starts[i], buffer + offsets[i]);
+			}
+
+			throw;
+		}
+		isBufferConstructed = true;
+
+		forEachChunk(threads, [&](std::size_t thread)
+		{
+			std::move(buffer + size * thread / threads, buffer + size * (thread + 1) / threads, std::next(first, size * thread / threads));
+		});
+	}
+
+	//big items are moved once by following the cycles of the permutation,
+	//at the cost of a random access per item instead of two sequential ones
+	template <typename Index, typename RandomAccessIt, typename IndexFn>
+	void CountingSorter::moveByPermutation(RandomAccessIt first, std::size_t size, std::size_t threads, std::size_t* offsets, std::size_t keysCount, IndexFn indexOf) const
+	{
+		auto permutation = std::vector<Index>(size);
+
+		forEachChunk(threads, [&](std::size_t thread)
+		{
+			auto chunkOffsets = offsets + thread * keysCount;
+
+			for (auto i = size * thread / threads; i < size * (thread + 1) / threads; ++i)
+			{
+				permutation[chunkOffsets[indexOf(first[i])]++] = static_cast<Index>(i);
+			}
+		});
+
+		applyPermutation(first, std::move(permutation));
+	}
+
+	template <typename RandomAccessIt, typename KeyFn>
+	void CountingSorter::sortByRadix(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf) const
+	{
+		auto sorter = (pool != nullptr) ? RadixSorter<>{ *pool, threadsCount } : RadixSorter<>{};
+		sorter.setThreadsCount(threadsCount);
+		sorter.setMemoryResource(resource);
+
+		sorter(first, last, [keyOf](const auto& item) { return Detail::toCountingKey(keyOf(item)); });
+	}
+}
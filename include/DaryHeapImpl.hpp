@@ -0,0 +1,273 @@
+#pragma once
+
+#include <stdexcept>
+
+namespace IDragnev::Algorithm
+{
+	template <typename T, std::size_t arity, typename CompareFn>
+	DaryHeap<T, arity, CompareFn>::DaryHeap(CompareFn lessThan, std::pmr::memory_resource* resource) :
+		resource((resource != nullptr) ? resource : std::pmr::get_default_resource()),
+		lessThan(lessThan)
+	{
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	template <typename InputIt>
+	DaryHeap<T, arity, CompareFn>::DaryHeap(InputIt first, InputIt last, CompareFn lessThan, std::pmr::memory_resource* resource) :
+		DaryHeap(lessThan, resource)
+	{
+		pushBatch(first, last);
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	DaryHeap<T, arity, CompareFn>::DaryHeap(const DaryHeap& source) :
+		DaryHeap(*source.lessThan, source.resource)
+	{
+		if (source.count > 0)
+		{
+			reserve(source.count);
+			std::uninitialized_copy_n(source.data(), source.count, data());
+			count = source.count;
+		}
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	DaryHeap<T, arity, CompareFn>::DaryHeap(DaryHeap&& source) noexcept :
+		storage(std::exchange(source.storage, nullptr)),
+		count(std::exchange(source.count, 0)),
+		capacity(std::exchange(source.capacity, 0)),
+		resource(source.resource),
+		lessThan(source.lessThan)
+	{
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline DaryHeap<T, arity, CompareFn>::~DaryHeap()
+	{
+		release();
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	auto DaryHeap<T, arity, CompareFn>::operator=(const DaryHeap& rhs) -> DaryHeap&
+	{
+		if (this != &rhs)
+		{
+			*this = DaryHeap{ rhs };
+		}
+
+		return *this;
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	auto DaryHeap<T, arity, CompareFn>::operator=(DaryHeap&& rhs) noexcept -> DaryHeap&
+	{
+		if (this != &rhs)
+		{
+			release();
+
+			storage = std::exchange(rhs.storage, nullptr);
+			count = std::exchange(rhs.count, 0);
+			capacity = std::exchange(rhs.capacity, 0);
+			resource = rhs.resource;
+			lessThan.emplace(*rhs.lessThan);
+		}
+
+		return *this;
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline void DaryHeap<T, arity, CompareFn>::push(const T& item)
+	{
+		emplace(item);
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline void DaryHeap<T, arity, CompareFn>::push(T&& item)
+	{
+		emplace(std::move(item));
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	template <typename... Args>
+	void DaryHeap<T, arity, CompareFn>::emplace(Args&&... args)
+	{
+		if (count == capacity)
+		{
+			//the arguments may refer to an item of the heap, so they are used before it grows
+			auto item = T(std::forward<Args>(args)...);
+			growFor(1);
+			::new (static_cast<void*>(data() + count)) T(std::move(item));
+		}
+		else
+		{
+			::new (static_cast<void*>(data() + count)) T(std::forward<Args>(args)...);
+		}
+
+		++count;
+		pushHeap<arity>(data(), data() + count, *lessThan);
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	template <typename InputIt>
+	void DaryHeap<T, arity, CompareFn>::pushBatch(InputIt first, InputIt last)
+	{
+		using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+		if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
+		{
+			growFor(static_cast<std::size_t>(std::distance(first, last)));
+		}
+
+		const auto oldCount = count;
+
+		try
+		{
+			for (; first != last; ++first)
+			{
+				growFor(1);
+				::new (static_cast<void*>(data() + count)) T(*first);
+				++count;
+			}
+		}
+		catch (...)
+		{
+			std::destroy(data() + oldCount, data() + count);
+			count = oldCount;
+			throw;
+		}
+
+		//pushes of items in random order move them up a level or two on average,
+		//so rebuilding pays off only when the batch is about as big as the heap
+		if (count - oldCount >= oldCount)
+		{
+			makeHeap<arity>(data(), data() + count, *lessThan);
+		}
+		else
+		{
+			for (auto i = oldCount; i < count; ++i)
+			{
+				Detail::siftUp<arity>(data(), static_cast<std::ptrdiff_t>(i), *lessThan);
+			}
+		}
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline const T& DaryHeap<T, arity, CompareFn>::top() const noexcept
+	{
+		return *data();
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	T DaryHeap<T, arity, CompareFn>::pop()
+	{
+		popHeap<arity>(data(), data() + count, *lessThan);
+
+		auto item = std::move(data()[--count]);
+		std::destroy_at(data() + count);
+
+		return item;
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	template <typename OutputIt>
+	OutputIt DaryHeap<T, arity, CompareFn>::popBatch(std::size_t count, OutputIt destination)
+	{
+		for (count = std::min(count, this->count); count > 0; --count)
+		{
+			popHeap<arity>(data(), data() + this->count, *lessThan);
+
+			auto last = data() + --this->count;
+			*destination = std::move(*last);
+			++destination;
+			std::destroy_at(last);
+		}
+
+		return destination;
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline void DaryHeap<T, arity, CompareFn>::reserve(std::size_t capacity)
+	{
+		if (capacity > this->capacity)
+		{
+			reallocate(capacity);
+		}
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline void DaryHeap<T, arity, CompareFn>::clear() noexcept
+	{
+		if (storage != nullptr)
+		{
+			std::destroy_n(data(), count);
+			count = 0;
+		}
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline std::size_t DaryHeap<T, arity, CompareFn>::size() const noexcept
+	{
+		return count;
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline bool DaryHeap<T, arity, CompareFn>::isEmpty() const noexcept
+	{
+		return count == 0;
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline void DaryHeap<T, arity, CompareFn>::growFor(std::size_t count)
+	{
+		if (count > maxCapacity - this->count)
+		{
+			throw std::length_error{ "The heap cannot hold that many items" };
+		}
+		else if (this->count + count > capacity)
+		{
+			reallocate(std::max(this->count + count, std::min(capacity, maxCapacity / 2) * 2));
+		}
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	void DaryHeap<T, arity, CompareFn>::reallocate(std::size_t capacity)
+	{
+		if (capacity > maxCapacity)
+		{
+			throw std::length_error{ "The heap cannot hold that many items" };
+		}
+
+		auto newStorage = static_cast<std::byte*>(resource->allocate((padding + capacity) * sizeof(T), alignment));
+		auto newData = reinterpret_cast<T*>(newStorage) + padding;
+
+		if (storage != nullptr)
+		{
+			std::uninitialized_move_n(data(), count, newData);
+			std::destroy_n(data(), count);
+			resource->deallocate(storage, (padding + this->capacity) * sizeof(T), alignment);
+		}
+
+		storage = newStorage;
+		this->capacity = capacity;
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	void DaryHeap<T, arity, CompareFn>::release() noexcept
+	{
+		if (storage != nullptr)
+		{
+			std::destroy_n(data(), count);
+			resource->deallocate(storage, (padding + capacity) * sizeof(T), alignment);
+
+			storage = nullptr;
+			count = 0;
+			capacity = 0;
+		}
+	}
+
+	template <typename T, std::size_t arity, typename CompareFn>
+	inline T* DaryHeap<T, arity, CompareFn>::data() const noexcept
+	{
+		return reinterpret_cast<T*>(storage) + padding;
+	}
+}
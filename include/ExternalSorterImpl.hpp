@@ -0,0 +1,347 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace IDragnev::Algorithm
+{
+	template <typename Record>
+	ExternalSorter<Record>::TemporaryFile::TemporaryFile(std::filesystem::path path) noexcept :
+		filePath(std::move(path))
+	{
+	}
+
+	template <typename Record>
+	ExternalSorter<Record>::TemporaryFile::TemporaryFile(TemporaryFile&& source) noexcept :
+		filePath(std::move(source.filePath))
+	{
+		source.filePath.clear();
+	}
+
+	template <typename Record>
+	ExternalSorter<Record>::TemporaryFile::~TemporaryFile()
+	{
+		if (!filePath.empty())
+		{
+			auto error = std::error_code{};
+			std::filesystem::remove(filePath, error);
+		}
+	}
+
+	template <typename Record>
+	inline const std::filesystem::path& ExternalSorter<Record>::TemporaryFile::path() const noexcept
+	{
+		return filePath;
+	}
+
+	template <typename Record>
+	ExternalSorter<Record>::RunReader::RunReader(const std::filesystem::path& path, std::size_t blockSize, Counter& bytesRead) :
+		file(open(path, "rb")),
+		block(blockSize),
+		bytesRead(&bytesRead)
+	{
+		refill();
+	}
+
+	template <typename Record>
+	inline bool ExternalSorter<Record>::RunReader::isExhausted() const noexcept
+	{
+		return position >= count;
+	}
+
+	template <typename Record>
+	inline const Record& ExternalSorter<Record>::RunReader::front() const noexcept
+	{
+		return block[position];
+	}
+
+	template <typename Record>
+	inline void ExternalSorter<Record>::RunReader::pop()
+	{
+		if (++position == count)
+		{
+			refill();
+		}
+	}
+
+	template <typename Record>
+	void ExternalSorter<Record>::RunReader::refill()
+	{
+		count = std::fread(block.data(), sizeof(Record), block.size(), file.get());
+		position = 0;
+		*bytesRead += count * sizeof(Record);
+
+		if (count < block.size() && std::ferror(file.get()))
+		{
+			throw std::runtime_error{ "Failed to read a run of records" };
+		}
+	}
+
+	template <typename Record>
+	ExternalSorter<Record>::RunWriter::RunWriter(const std::filesystem::path& path, std::size_t blockSize, Counter& bytesWritten) :
+		file(open(path, "wb")),
+		bytesWritten(&bytesWritten)
+	{
+		block.reserve(blockSize);
+	}
+
+	template <typename Record>
+	inline void ExternalSorter<Record>::RunWriter::push(const Record& record)
+	{
+		block.push_back(record);
+
+		if (block.size() == block.capacity())
+		{
+			flush();
+		}
+	}
+
+	template <typename Record>
+	void ExternalSorter<Record>::RunWriter::write(const Record* first, const Record* last)
+	{
+		flush();
+
+		auto count = static_cast<std::size_t>(last - first);
+		if (std::fwrite(first, sizeof(Record), count, file.get()) != count)
+		{
+			throw std::runtime_error{ "Failed to write a run of records" };
+		}
+
+		*bytesWritten += count * sizeof(Record);
+	}
+
+	template <typename Record>
+	void ExternalSorter<Record>::RunWriter::flush()
+	{
+		if (block.empty())
+		{
+			return;
+		}
+
+		if (std::fwrite(block.data(), sizeof(Record), block.size(), file.get()) != block.size() ||
+			std::fflush(file.get()) != 0)
+		{
+			throw std::runtime_error{ "Failed to write a run of records" };
+		}
+
+		*bytesWritten += block.size() * sizeof(Record);
+		block.clear();
+	}
+
+	//the stream may hold back the tail of a run until it is flushed or closed,
+	//so a run is complete only if both succeed. The deleter closes the file
+	//only when a sort is unwound
+	template <typename Record>
+	void ExternalSorter<Record>::RunWriter::close()
+	{
+		flush();
+
+		auto isFlushed = std::fflush(file.get()) == 0;
+		auto isClosed = std::fclose(file.release()) == 0;
+
+		if (!isFlushed || !isClosed)
+		{
+			throw std::runtime_error{ "Failed to write a run of records" };
+		}
+	}
+
+	template <typename Record>
+	ExternalSorter<Record>::ExternalSorter(std::size_t memoryBudget, std::filesystem::path temporaryDirectory) :
+		memoryBudget(memoryBudget),
+		temporaryDirectory(std::move(temporaryDirectory))
+	{
+		//a run needs room for a record and its scratch, a merge needs two inputs and an output
+		if (memoryBudget < 3 * sizeof(Record))
+		{
+			throw std::invalid_argument{ "The memory budget must fit at least three records" };
+		}
+	}
+
+	template <typename Record>
+	template <typename CompareFn>
+	void ExternalSorter<Record>::operator()(const std::filesystem::path& input, const std::filesystem::path& output, CompareFn lessThan)
+	{
+		resetProgress();
+
+		auto runs = createRuns(input, output, lessThan);
+		const auto fanIn = maxFanIn();
+
+		//runs are merged in consecutive groups so equal records keep their order
+		while (runs.size() > fanIn)
+		{
+			auto mergedRuns = std::vector<TemporaryFile>{};
+
+			for (auto first = std::size_t{ 0 }; first < runs.size(); first += fanIn)
+			{
+				if (auto last = std::min(first + fanIn, runs.size());
+					last - first == 1)
+				{
+					mergedRuns.push_back(std::move(runs[first]));
+				}
+				else
+				{
+					auto run = makeTemporaryFile();
+					mergeRuns(runs, first, last, run.path(), lessThan);
+					mergedRuns.push_back(std::move(run));
+				}
+			}
+
+			runs = std::move(mergedRuns);
+			++mergePasses;
+		}
+
+		if (!runs.empty())
+		{
+			mergeRuns(runs, 0, runs.size(), output, lessThan);
+			++mergePasses;
+		}
+
+		finishTime = Clock::now().time_since_epoch().count();
+	}
+
+	template <typename Record>
+	template <typename CompareFn>
+	auto ExternalSorter<Record>::createRuns(const std::filesystem::path& input, const std::filesystem::path& output, CompareFn lessThan) -> std::vector<TemporaryFile>
+	{
+		if (std::filesystem::file_size(input) % sizeof(Record) != 0)
+		{
+			throw std::invalid_argument{ "The size of " + input.string() + " is not a multiple of the record size" };
+		}
+
+		const auto runCapacity = memoryBudget / (2 * sizeof(Record));
+		auto inputFile = open(input, "rb");
+		auto records = std::vector<Record>(runCapacity);
+		auto sorter = MergeSorter<Record*>{};
+		auto runs = std::vector<TemporaryFile>{};
+
+		while (true)
+		{
+			auto count = std::fread(records.data(), sizeof(Record), runCapacity, inputFile.get());
+			bytesRead += count * sizeof(Record);
+
+			if (count < runCapacity && std::ferror(inputFile.get()))
+			{
+				throw std::runtime_error{ "Failed to read " + input.string() };
+			}
+
+			sorter(records.data(), records.data() + count, lessThan);
+
+			//an input which fits in a single read needs no merging
+			if (runs.empty() && count < runCapacity)
+			{
+				auto writer = RunWriter{ output, 0, bytesWritten };
+				writer.write(records.data(), records.data() + count);
+				writer.close();
+				return runs;
+			}
+			else if (count == 0)
+			{
+				return runs;
+			}
+
+			auto run = makeTemporaryFile();
+			auto writer = RunWriter{ run.path(), 0, bytesWritten };
+			writer.write(records.data(), records.data() + count);
+			writer.close();
+			runs.push_back(std::move(run));
+			++runsCreated;
+		}
+	}
+
+	template <typename Record>
+	template <typename CompareFn>
+	void ExternalSorter<Record>::mergeRuns(const std::vector<TemporaryFile>& runs, 
+										   std::size_t first, std::size_t last,
+										   const std::filesystem::path& output, 
+										   CompareFn lessThan)
+	{
+		const auto k = last - first;
+		const auto blockSize = std::max(memoryBudget / ((k + 1) * sizeof(Record)), std::size_t{ 1 });
+
+		auto readers = std::vector<RunReader>{};
+		readers.reserve(k);
+		for (auto i = first; i < last; ++i)
+		{
+			readers.emplace_back(runs[i].path(), blockSize, bytesRead);
+		}
+
+		auto writer = RunWriter{ output, blockSize, bytesWritten };
+		auto comesFirst = [&readers, lessThan](std::size_t i, std::size_t j)
+		{
+			if (readers[i].isExhausted()) return false;
+			if (readers[j].isExhausted()) return true;
+
+			//ties go to the earlier run
+			return (i < j) ? !lessThan(readers[j].front(), readers[i].front()) 
+						   : lessThan(readers[i].front(), readers[j].front());
+		};
+
+		auto tree = LoserTree{ k, comesFirst };
+
+		for (auto winner = tree.winner();
+			 !readers[winner].isExhausted();
+			 winner = tree.winner())
+		{
+			writer.push(readers[winner].front());
+			readers[winner].pop();
+			tree.replay();
+		}
+
+		writer.close();
+	}
+
+	template <typename Record>
+	auto ExternalSorter<Record>::makeTemporaryFile() -> TemporaryFile
+	{
+		auto name = "IDragnev-run-" + 
+					std::to_string(Clock::now().time_since_epoch().count()) + "-" +
+					std::to_string(reinterpret_cast<std::uintptr_t>(this)) + "-" +
+					std::to_string(temporaryFilesCount++);
+
+		return TemporaryFile{ temporaryDirectory / name };
+	}
+
+	template <typename Record>
+	std::size_t ExternalSorter<Record>::maxFanIn() const noexcept
+	{
+		//prefer blocks of 1 MiB per run for long sequential reads
+		const auto preferredBlockBytes = std::max(sizeof(Record), std::size_t{ 1 } << 20);
+		const auto blocks = memoryBudget / preferredBlockBytes;
+
+		return std::max(blocks, std::size_t{ 3 }) - 1;
+	}
+
+	template <typename Record>
+	void ExternalSorter<Record>::resetProgress()
+	{
+		bytesRead = 0;
+		bytesWritten = 0;
+		runsCreated = 0;
+		mergePasses = 0;
+		finishTime = 0;
+		startTime = Clock::now().time_since_epoch().count();
+	}
+
+	template <typename Record>
+	ExternalSortProgress ExternalSorter<Record>::getProgress() const noexcept
+	{
+		const auto start = startTime.load();
+		const auto finish = finishTime.load();
+		const auto end = (finish != 0) ? finish : Clock::now().time_since_epoch().count();
+		const auto elapsed = (start != 0) ? Clock::duration{ end - start } : Clock::duration::zero();
+
+		return { bytesRead.load(), bytesWritten.load(), runsCreated.load(), mergePasses.load(), elapsed };
+	}
+
+	template <typename Record>
+	auto ExternalSorter<Record>::open(const std::filesystem::path& path, const char* mode) -> File
+	{
+		if (auto file = std::fopen(path.string().c_str(), mode);
+			file != nullptr)
+		{
+			return File{ file, &std::fclose };
+		}
+
+		throw std::runtime_error{ "Failed to open " + path.string() };
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+namespace IDragnev::Algorithm
+{
+	namespace Detail
+	{
+		//picks the greatest sibling with conditional moves instead of branches.
+		//The loop stops at the last sibling, so the partial group at the end
+		//of the heap needs no path of its own
+		template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+		inline std::ptrdiff_t greatestChild(RandomAccessIt first, std::ptrdiff_t length, std::ptrdiff_t child, CompareFn lessThan)
+		{
+			constexpr auto width = static_cast<std::ptrdiff_t>(arity);
+
+			auto greatest = child;
+			const auto last = std::min(child + width, length);
+			for (auto sibling = child + 1; sibling < last; ++sibling)
+			{
+				greatest = lessThan(first[greatest], first[sibling]) ? sibling : greatest;
+			}
+
+			return greatest;
+		}
+
+		template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+		void siftDown(RandomAccessIt first, std::ptrdiff_t length, std::ptrdiff_t hole, CompareFn lessThan)
+		{
+			constexpr auto width = static_cast<std::ptrdiff_t>(arity);
+
+			auto item = std::move(first[hole]);
+
+			for (auto child = width * hole + 1; child < length; child = width * hole + 1)
+			{
+				auto greatest = greatestChild<arity>(first, length, child, lessThan);
+
+				if (!lessThan(item, first[greatest]))
+				{
+					break;
+				}
+
+				first[hole] = std::move(first[greatest]);
+				hole = greatest;
+			}
+
+			first[hole] = std::move(item);
+		}
+
+		template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+		void siftUp(RandomAccessIt first, std::ptrdiff_t hole, CompareFn lessThan)
+		{
+			constexpr auto width = static_cast<std::ptrdiff_t>(arity);
+
+			auto item = std::move(first[hole]);
+
+			for (auto parent = (hole - 1) / width; hole > 0 && lessThan(first[parent], item); parent = (hole - 1) / width)
+			{
+				first[hole] = std::move(first[parent]);
+				hole = parent;
+			}
+
+			first[hole] = std::move(item);
+		}
+
+		//the item replacing a popped one comes from the bottom and usually belongs
+		//there, so the hole is moved down to a leaf without comparing against it
+		//and the item is sifted up from there
+		template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+		void siftDownToLeaf(RandomAccessIt first, std::ptrdiff_t length, CompareFn lessThan)
+		{
+			constexpr auto width = static_cast<std::ptrdiff_t>(arity);
+
+			auto item = std::move(first[0]);
+			auto hole = std::ptrdiff_t{ 0 };
+
+			for (auto child = std::ptrdiff_t{ 1 }; child < length; child = width * hole + 1)
+			{
+				auto greatest = greatestChild<arity>(first, length, child, lessThan);
+				first[hole] = std::move(first[greatest]);
+				hole = greatest;
+			}
+
+			first[hole] = std::move(item);
+			siftUp<arity>(first, hole, lessThan);
+		}
+	}
+
+	template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+	void makeHeap(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		static_assert(arity >= 2, "Heaps must have at least two children per item");
+
+		const auto length = last - first;
+		if (length < 2)
+		{
+			return;
+		}
+
+		for (auto parent = (length - 2) / static_cast<std::ptrdiff_t>(arity); parent >= 0; --parent)
+		{
+			Detail::siftDown<arity>(first, length, parent, lessThan);
+		}
+	}
+
+	template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+	inline void pushHeap(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		static_assert(arity >= 2, "Heaps must have at least two children per item");
+
+		if (last - first > 1)
+		{
+			Detail::siftUp<arity>(first, last - first - 1, lessThan);
+		}
+	}
+
+	template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+	inline void popHeap(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		static_assert(arity >= 2, "Heaps must have at least two children per item");
+
+		if (last - first > 1)
+		{
+			std::iter_swap(first, --last);
+			Detail::siftDownToLeaf<arity>(first, last - first, lessThan);
+		}
+	}
+
+	template <std::size_t arity, typename RandomAccessIt, typename CompareFn>
+	void heapSort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		makeHeap<arity>(first, last, lessThan);
+
+		for (; last - first > 1; --last)
+		{
+			popHeap<arity>(first, last, lessThan);
+		}
+	}
+}
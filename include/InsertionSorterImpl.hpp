@@ -5,6 +5,11 @@ namespace IDragnev::Algorithm
 	template <typename RandomAcessIt, typename CompareFn>
 	inline void InsertionSorter::operator()(RandomAcessIt first, RandomAcessIt last, CompareFn lessThan) const
 	{
+		if (first == last)
+		{
+			return;
+		}
+
 		putMinimalInFront(first, last, lessThan);
 		doSort(++first, last, lessThan);
 	}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <array>
+
+namespace IDragnev::Algorithm
+{
+	template <typename ComesFirst>
+	LoserTree<ComesFirst>::LoserTree(std::size_t size, ComesFirst comesFirst) :
+		losers(size),
+		comesFirst(std::move(comesFirst))
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		//players are the leaves size..2size-1 of a complete binary tree,
+		//inner nodes keep the loser of the match played at them
+		auto winners = std::vector<std::size_t>(2 * size);
+
+		for (auto i = std::size_t{ 0 }; i < size; ++i)
+		{
+			winners[size + i] = i;
+		}
+		for (auto node = size - 1; node >= 1; --node)
+		{
+			auto left = winners[2 * node];
+			auto right = winners[2 * node + 1];
+			auto leftWins = this->comesFirst(left, right);
+
+			winners[node] = leftWins ? left : right;
+			losers[node] = leftWins ? right : left;
+		}
+
+		top = winners[1];
+	}
+
+	template <typename ComesFirst>
+	inline std::size_t LoserTree<ComesFirst>::winner() const noexcept
+	{
+		return top;
+	}
+
+	template <typename ComesFirst>
+	void LoserTree<ComesFirst>::replay()
+	{
+		//only the matches on the path of the last winner can change
+		for (auto node = (top + losers.size()) / 2; node >= 1; node /= 2)
+		{
+			if (comesFirst(losers[node], top))
+			{
+				std::swap(losers[node], top);
+			}
+		}
+	}
+
+	namespace Detail
+	{
+		//ranges which run out are dropped from the array, so the scan needs
+		//no end checks and keeps ties going to the first of the equal heads.
+		//The last two ranges are left to std::merge
+		template <typename Cursor, std::size_t maxCount, typename OutputIt, typename CompareFn>
+		OutputIt mergeByScan(std::array<Cursor, maxCount>& cursors, std::size_t k, OutputIt destination, CompareFn lessThan)
+		{
+			k = static_cast<std::size_t>(std::remove_if(std::begin(cursors), std::begin(cursors) + k, [](const Cursor& cursor) { return cursor.first == cursor.second; }) - std::begin(cursors));
+
+			while (k > 2)
+			{
+				auto smallest = std::size_t{ 0 };
+
+				for (auto i = std::size_t{ 1 }; i < k; ++i)
+				{
+					smallest = lessThan(*cursors[i].first, *cursors[smallest].first) ? i : smallest;
+				}
+
+				auto& [current, end] = cursors[smallest];
+				*destination = *current;
+				++destination;
+
+				if (++current == end)
+				{
+					std::move(std::begin(cursors) + smallest + 1, std::begin(cursors) + k, std::begin(cursors) + smallest);
+					--k;
+				}
+			}
+
+			//std::merge takes equal items from its first range first too
+			if (k == 2)
+			{
+				return std::merge(cursors[0].first, cursors[0].second, cursors[1].first, cursors[1].second, destination, lessThan);
+			}
+
+			return (k == 1) ? std::copy(cursors[0].first, cursors[0].second, destination) : destination;
+		}
+
+		//the nodes of the tournament keep a copy of the head of their range, so a replay
+		//compares the copies instead of following the cursors of both players.
+		//A range which ran out is marked by adding k to its index
+		template <typename Cursor, typename OutputIt, typename CompareFn>
+		OutputIt mergeByCachedTree(std::vector<Cursor>& cursors, OutputIt destination, CompareFn lessThan)
+		{
+			using Item = typename std::iterator_traits<decltype(std::declval<Cursor>().first)>::value_type;
+
+			const auto k = cursors.size();
+
+			//ties go to the earlier range. The result is put together from all comparisons
+			//with bitwise operators and the players are kept in separate arrays of items
+			//and ranges, which lets the matches compile to conditional moves
+			auto comesFirst = [lessThan, k](const Item& x, std::size_t xRange, const Item& y, std::size_t yRange)
+			{
+				auto isLess = static_cast<bool>(lessThan(x, y));
+				auto isGreater = static_cast<bool>(lessThan(y, x));
+				auto isOrdered = isLess | (!isGreater & (xRange < yRange));
+
+				return (xRange < k) & ((yRange >= k) | isOrdered);
+			};
+
+			//players are the leaves k..2k-1 of a complete binary tree
+			auto winnerItems = std::vector<Item>(2 * k);
+			auto winnerRanges = std::vector<std::size_t>(2 * k);
+			for (auto i = std::size_t{ 0 }; i < k; ++i)
+			{
+				auto [current, end] = cursors[i];
+				winnerItems[k + i] = (current != end) ? *current : Item{};
+				winnerRanges[k + i] = (current != end) ? i : i + k;
+			}
+
+			auto loserItems = std::vector<Item>(k);
+			auto loserRanges = std::vector<std::size_t>(k);
+			for (auto node = k - 1; node >= 1; --node)
+			{
+				auto left = 2 * node;
+				auto right = left + 1;
+				auto leftWins = comesFirst(winnerItems[left], winnerRanges[left], winnerItems[right], winnerRanges[right]);
+				auto winner = leftWins ? left : right;
+				auto loser = leftWins ? right : left;
+
+				winnerItems[node] = winnerItems[winner];
+				winnerRanges[node] = winnerRanges[winner];
+				loserItems[node] = winnerItems[loser];
+				loserRanges[node] = winnerRanges[loser];
+			}
+
+			auto winnerItem = winnerItems[1];
+			auto winnerRange = winnerRanges[1];
+
+			while (winnerRange < k)
+			{
+				*destination = winnerItem;
+				++destination;
+
+				//only the matches on the path of the last winner can change
+				auto node = (winnerRange + k) / 2;
+				if (auto& [current, end] = cursors[winnerRange]; ++current != end)
+				{
+					winnerItem = *current;
+				}
+				else
+				{
+					winnerRange += k;
+				}
+
+				//the players of a match are picked by indexing a pair of them, as compilers
+				//turn a choice between two values stored back to memory into a branch
+				for (; node >= 1; node /= 2)
+				{
+					const Item items[] = { winnerItem, loserItems[node] };
+					const std::size_t ranges[] = { winnerRange, loserRanges[node] };
+					auto isSwapped = static_cast<std::size_t>(comesFirst(items[1], ranges[1], items[0], ranges[0]));
+
+					loserItems[node] = items[1 - isSwapped];
+					loserRanges[node] = ranges[1 - isSwapped];
+					winnerItem = items[isSwapped];
+					winnerRange = ranges[isSwapped];
+				}
+			}
+
+			return destination;
+		}
+	}
+
+	template <typename RangesIt, typename OutputIt, typename CompareFn>
+	OutputIt kWayMerge(RangesIt firstRange, RangesIt lastRange, OutputIt destination, CompareFn lessThan)
+	{
+		using Range = typename std::iterator_traits<RangesIt>::value_type;
+		using InputIt = decltype(std::declval<Range>().first);
+		using Item = typename std::iterator_traits<InputIt>::value_type;
+		using Cursor = std::pair<InputIt, InputIt>;
+
+		const auto k = static_cast<std::size_t>(std::distance(firstRange, lastRange));
+		constexpr auto maxScannedCount = std::size_t{ 4 };
+
+		//a few ranges are scanned linearly from a local array
+		if (k <= maxScannedCount)
+		{
+			auto cursors = std::array<Cursor, maxScannedCount>{};
+			std::transform(firstRange, lastRange, std::begin(cursors), [](const auto& range) { return Cursor{ range.first, range.second }; });
+
+			return Detail::mergeByScan(cursors, k, destination, lessThan);
+		}
+
+		auto cursors = std::vector<Cursor>{};
+		cursors.reserve(k);
+		std::transform(firstRange, lastRange, std::back_inserter(cursors), [](const auto& range) { return Cursor{ range.first, range.second }; });
+
+		//small items are cheaper to copy into the tree than to reach through their cursors
+		if constexpr (std::is_trivially_copyable_v<Item> && std::is_default_constructible_v<Item> && sizeof(Item) <= 16)
+		{
+			return Detail::mergeByCachedTree(cursors, destination, lessThan);
+		}
+		else
+		{
+			auto comesFirst = [&cursors, lessThan](std::size_t i, std::size_t j)
+			{
+				auto& [iCurrent, iEnd] = cursors[i];
+				auto& [jCurrent, jEnd] = cursors[j];
+
+				if (iCurrent == iEnd) return false;
+				if (jCurrent == jEnd) return true;
+
+				return (i < j) ? !lessThan(*jCurrent, *iCurrent) : lessThan(*iCurrent, *jCurrent);
+			};
+			auto tree = LoserTree{ k, comesFirst };
+
+			for (auto winner = tree.winner();
+				 cursors[winner].first != cursors[winner].second;
+				 winner = tree.winner())
+			{
+				*destination = *cursors[winner].first;
+				++cursors[winner].first;
+				++destination;
+				tree.replay();
+			}
+
+			return destination;
+		}
+	}
+}
@@ -1,128 +1,871 @@
 #pragma once
 
 #include "InsertionSorterImpl.hpp"
+#include <cstring>
+#include <limits>
+#include <new>
 
 namespace IDragnev::Algorithm
 {
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	MergeSorter<RandomAccessIt, lowerBound>::MergeSorter(const MergeSorter&) noexcept
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::MergeSorter(ThreadPool& pool) noexcept :
+		pool(&pool)
 	{
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	auto MergeSorter<RandomAccessIt, lowerBound>::operator=(const MergeSorter&) noexcept -> MergeSorter&
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::MergeSorter(ThreadPool& pool, std::size_t grain) noexcept :
+		pool(&pool),
+		grain(grain)
 	{
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::MergeSorter(const MergeSorter& source) noexcept :
+		pool(source.pool),
+		grain(source.grain),
+		leafLength(source.leafLength),
+		sequentialCutoff(source.sequentialCutoff),
+		strategy(source.strategy),
+		resource(source.resource),
+		scratchLimit(source.scratchLimit)
+	{
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	auto MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::operator=(const MergeSorter& rhs) noexcept -> MergeSorter&
+	{
+		pool = rhs.pool;
+		grain = rhs.grain;
+		leafLength = rhs.leafLength;
+		sequentialCutoff = rhs.sequentialCutoff;
+		strategy = rhs.strategy;
+		resource = rhs.resource;
+		scratchLimit = rhs.scratchLimit;
 		return *this;
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::setParallelGrain(std::size_t grain) noexcept
+	{
+		this->grain = grain;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline std::size_t MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::getParallelGrain() const noexcept
+	{
+		return grain;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::setStrategy(MergeStrategy strategy) noexcept
+	{
+		this->strategy = strategy;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline MergeStrategy MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::getStrategy() const noexcept
+	{
+		return strategy;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	MergeStatistics MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::getStatistics() const noexcept
+	{
+		return { mergesCount.load(), skippedMergesCount.load(), rotationsCount.load() };
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::resetStatistics() noexcept
+	{
+		mergesCount = 0;
+		skippedMergesCount = 0;
+		rotationsCount = 0;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::setMemoryResource(std::pmr::memory_resource* resource) noexcept
+	{
+		this->resource = resource;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline std::pmr::memory_resource* MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::getMemoryResource() const noexcept
+	{
+		return (resource != nullptr) ? resource : std::pmr::get_default_resource();
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::setScratchLimit(std::size_t items) noexcept
+	{
+		scratchLimit = items;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline std::size_t MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::getScratchLimit() const noexcept
+	{
+		return scratchLimit;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::setLeafLength(std::size_t items) noexcept
+	{
+		leafLength = std::clamp<std::size_t>(items, 1, std::numeric_limits<Difference>::max());
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline std::size_t MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::getLeafLength() const noexcept
+	{
+		return leafLength;
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::setTuning(const MergeSorterTuning& tuning) noexcept
+	{
+		setLeafLength(tuning.leafLength);
+		setParallelGrain(tuning.parallelGrain);
+		setStrategy(tuning.strategy);
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	MergeSorterTuning MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::getTuning() const noexcept
+	{
+		return { leafLength, grain, strategy };
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
 	template <typename CompareFn>
-	void MergeSorter<RandomAccessIt, lowerBound>::operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
 	{
+		//an empty range has no first item to take the address of
 		if (auto length = std::distance(first, last);
-			length <= lowerBound)
+			length < 2)
+		{
+			return;
+		}
+		else if (length <= static_cast<Difference>(leafLength))
 		{
-			InsertionSorter{}(first, last, lessThan);
+			if constexpr (isContiguousIterator<RandomAccessIt>)
+			{
+				auto items = std::addressof(*first);
+				sortLeaf(items, items + length, lessThan);
+			}
+			else
+			{
+				sortLeaf(first, last, lessThan);
+			}
+		}
+		else
+		{
+			//a merge of two single items cannot be split any further
+			sequentialCutoff = std::max({ (grain > 0) ? static_cast<Difference>(std::min<std::size_t>(grain, length)) : defaultGrain(length),
+										  static_cast<Difference>(leafLength),
+										  Difference{ 2 } });
+			auto bufferSize = std::min(static_cast<std::size_t>(length), scratchLimit);
+			auto buffer = makeBuffer(bufferSize);
+			auto scratch = Scratch{ buffer.get(), static_cast<Difference>(bufferSize) };
+
+			if constexpr (isContiguousIterator<RandomAccessIt>)
+			{
+				auto items = std::addressof(*first);
+				sortWithBuffer(items, items + length, scratch, lessThan);
+			}
+			else
+			{
+				sortWithBuffer(first, last, scratch, lessThan);
+			}
+		}
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::sortLeaf(Iterator first, Iterator last, CompareFn lessThan)
+	{
+		//the network only stands in for the default leaf sorter and
+		//leaves the keys it cannot sort stably to it
+		if constexpr (std::is_same_v<LeafSorter, InsertionSorter> &&
+					  std::is_pointer_v<Iterator> && 
+					  Detail::isPlainOrdering<Item, CompareFn> && 
+					  Detail::SortingNetwork::isSupportedKey<Item>)
+		{
+			constexpr auto descending = std::is_same_v<CompareFn, std::greater<>> || std::is_same_v<CompareFn, std::greater<Item>>;
+
+			if (Detail::SortingNetwork::sort(first, static_cast<std::size_t>(last - first), descending))
+			{
+				return;
+			}
+		}
+
+		LeafSorter{}(first, last, lessThan);
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::sortWithBuffer(Iterator first, Iterator last, Scratch scratch, CompareFn lessThan)
+	{
+		auto buffer = scratch.items;
+
+		if (strategy == MergeStrategy::natural)
+		{
+			sortNaturally(first, last, scratch, lessThan);
+		}
+		else if (scratch.size < std::distance(first, last))
+		{
+			sortInPlace(first, last, scratch, lessThan);
+		}
+		else if constexpr (std::is_trivially_copyable_v<Item>)
+		{
+			sort(first, last, buffer, false, lessThan);
+		}
+		else
+		{
+			//the buffer holds the items while they are sorted 
+			//and every level merges them into the other range
+			auto bufferEnd = std::uninitialized_move(first, last, buffer);
+			auto x = CallOnDestruction{ [buffer, bufferEnd]() noexcept { std::destroy(buffer, bufferEnd); } };
+
+			sort(buffer, bufferEnd, first, true, lessThan);
+		}
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	auto MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::makeBuffer(std::size_t size) const -> Buffer
+	{
+		if (size == 0)
+		{
+			return Buffer{ nullptr, BufferDeleter{} };
+		}
+		else if (size > std::numeric_limits<std::size_t>::max() / sizeof(Item))
+		{
+			throw std::bad_array_new_length{};
+		}
+
+		auto source = getMemoryResource();
+		auto items = static_cast<Item*>(source->allocate(size * sizeof(Item), alignof(Item)));
+
+		return Buffer{ items, BufferDeleter{ source, size } };
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	auto MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::defaultGrain(Difference length) const -> Difference
+	{
+		if (auto threads = static_cast<Difference>(threadPool().workersCount());
+			threads > 0)
+		{
+			return std::max(length / (threads * 8), static_cast<Difference>(leafLength));
+		}
+		else
+		{
+			return length;
+		}
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename SourceIt, typename DestIt, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::sort(SourceIt first, SourceIt last, DestIt destination, bool intoDestination, CompareFn lessThan)
+	{
+		if (auto length = std::distance(first, last);
+			length <= static_cast<Difference>(leafLength))
+		{
+			sortLeaf(first, last, lessThan);
+
+			if (intoDestination)
+			{
+				moveItems(first, last, destination);
+			}
 		}
 		else
 		{
-			auto x = CallOnDestruction{ [this]() noexcept { clear(); } };
 			auto middle = std::next(first, length / 2);
-			auto mergeSort = [sorter = *this, first, middle, lessThan]() mutable { sorter(first, middle, lessThan); };
-			auto lowerHalfBarrier = std::async(mergeSort);
 
-			(*this)(middle, last, lessThan);
-			lowerHalfBarrier.wait();
+			//the halves are sorted into the range which the result does not go to
+			auto sortLowerHalf = [=]() { sort(first, middle, destination, !intoDestination, lessThan); };
+			auto sortUpperHalf = [=]() { sort(middle, last, std::next(destination, length / 2), !intoDestination, lessThan); };
 
-			merge(first, middle, last, lessThan);
+			if (length <= sequentialCutoff)
+			{
+				sortLowerHalf();
+				sortUpperHalf();
+			}
+			else
+			{
+				runInParallel(sortLowerHalf, sortUpperHalf);
+			}
+
+			if (intoDestination)
+			{
+				mergeHalves(first, middle, last, destination, lessThan);
+			}
+			else
+			{
+				mergeHalves(destination, std::next(destination, length / 2), std::next(destination, length), first, lessThan);
+			}
 		}
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	template <typename CompareFn>
-	void MergeSorter<RandomAccessIt, lowerBound>::merge(RandomAccessIt first, RandomAccessIt middle, RandomAccessIt last, CompareFn lessThan)
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename InputIt, typename OutputIt, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeHalves(InputIt first, InputIt middle, InputIt last, OutputIt destination, CompareFn lessThan)
+	{
+		//halves in order or swapped end to end only need to be moved
+		if (!lessThan(*middle, *std::prev(middle)))
+		{
+			skippedMergesCount.fetch_add(1, std::memory_order_relaxed);
+			moveItems(middle, last, moveItems(first, middle, destination));
+		}
+		else if (lessThan(*std::prev(last), *first))
+		{
+			rotationsCount.fetch_add(1, std::memory_order_relaxed);
+			moveItems(first, middle, moveItems(middle, last, destination));
+		}
+		else
+		{
+			mergesCount.fetch_add(1, std::memory_order_relaxed);
+			mergeInParallel(first, middle, middle, last, destination, lessThan);
+		}
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename LowerPart, typename UpperPart>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::runInParallel(LowerPart lower, UpperPart upper)
+	{
+		auto& workers = threadPool();
+		auto lowerPartBarrier = workers.submit(lower);
+		auto x = CallOnDestruction{ [&workers, &lowerPartBarrier]() noexcept { workers.wait(lowerPartBarrier); } };
+
+		upper();
+		workers.wait(lowerPartBarrier);
+		lowerPartBarrier.get();
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename InputIt, typename OutputIt, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeInParallel(InputIt first1, InputIt last1,
+																				 InputIt first2, InputIt last2, 
+																				 OutputIt destination,
+																				 CompareFn lessThan)
+	{
+		auto length1 = std::distance(first1, last1);
+		auto length2 = std::distance(first2, last2);
+
+		if (length1 + length2 <= sequentialCutoff || length1 == 0 || length2 == 0)
+		{
+			merge(first1, last1, first2, last2, destination, lessThan);
+			return;
+		}
+
+		//split the larger range in half and the other one at the position
+		//of the splitting item, ties go to the lower part from the first range
+		auto split1 = first1;
+		auto split2 = first2;
+
+		if (length1 >= length2)
+		{
+			split1 = std::next(first1, length1 / 2);
+			split2 = Algorithm::lowerBound(first2, last2, *split1, lessThan);
+		}
+		else
+		{
+			split2 = std::next(first2, length2 / 2);
+			split1 = Algorithm::lowerBound(first1, last1, *split2, [lessThan](const auto& item, const auto& splitter)
+			{
+				return !lessThan(splitter, item);
+			});
+		}
+
+		auto destinationSplit = std::next(destination, std::distance(first1, split1) + std::distance(first2, split2));
+
+		runInParallel([=]() { mergeInParallel(first1, split1, first2, split2, destination, lessThan); },
+					  [=]() { mergeInParallel(split1, last1, split2, last2, destinationSplit, lessThan); });
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	inline ThreadPool& MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::threadPool() const
 	{
-		init(first, middle, last);
-		mergeInBuffer(lessThan);
-		moveResultBack();
+		return (pool != nullptr) ? *pool : ThreadPool::shared();
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	void MergeSorter<RandomAccessIt, lowerBound>::init(RandomAccessIt first, RandomAccessIt mid, RandomAccessIt last)
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename InputIt, typename OutputIt, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::merge(InputIt first1, InputIt last1,
+																	   InputIt first2, InputIt last2, 
+																	   OutputIt destination, 
+																	   CompareFn lessThan)
 	{
-		this->first = first;
-		left = 0;
-		right = middle = std::distance(first, mid);
-		length = std::distance(first, last);
-		buffer.reserve(length);
+		if constexpr (hasBranchlessMerge<InputIt, OutputIt, CompareFn>)
+		{
+			mergeBranchless(first1, last1, first2, last2, destination, lessThan);
+			return;
+		}
+
+		auto left = first1;
+		auto right = first2;
+
+		while (left != last1 && right != last2)
+		{
+			if (lessThan(*right, *left))
+			{
+				*destination = std::move(*right);
+				++right;
+			}
+			else
+			{
+				*destination = std::move(*left);
+				++left;
+			}
+
+			++destination;
+		}
+
+		destination = moveItems(left, last1, destination);
+		moveItems(right, last2, destination);
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
 	template <typename CompareFn>
-	void MergeSorter<RandomAccessIt, lowerBound>::mergeInBuffer(CompareFn lessThan)
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeBranchless(const Item* first1, const Item* last1,
+																				 const Item* first2, const Item* last2,
+																				 Item* destination, 
+																				 CompareFn lessThan)
+	{
+		auto left = first1;
+		auto right = first2;
+
+		//the comparison only selects values and advances pointers, so
+		//the compiler emits conditional moves instead of jumps on the data
+		while (left != last1 && right != last2)
+		{
+			auto leftItem = *left;
+			auto rightItem = *right;
+			auto takeRight = lessThan(rightItem, leftItem);
+
+			*destination++ = takeRight ? rightItem : leftItem;
+			right += takeRight;
+			left += !takeRight;
+		}
+
+		destination = moveItems(left, last1, destination);
+		moveItems(right, last2, destination);
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename InputIt, typename OutputIt>
+	inline OutputIt MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::moveItems(InputIt first, InputIt last, OutputIt destination)
 	{
-		while (!(isLeftPartExhausted() && isRightPartExhausted()))
+		if constexpr (std::is_pointer_v<InputIt> && 
+					  std::is_pointer_v<OutputIt> && 
+					  std::is_trivially_copyable_v<Item>)
 		{
-			while (!isLeftPartExhausted() && (isRightPartExhausted() || !rightPointsToSmallerItem(lessThan)))
+			auto count = static_cast<std::size_t>(last - first);
+			if (count > 0)
 			{
-				insertFromLeftPart();
+				std::memcpy(destination, first, count * sizeof(Item));
 			}
 
-			while (!isRightPartExhausted() && (isLeftPartExhausted() || rightPointsToSmallerItem(lessThan)))
+			return destination + count;
+		}
+		else
+		{
+			return std::move(first, last, destination);
+		}
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::sortNaturally(Iterator first, Iterator last, Scratch scratch, CompareFn lessThan)
+	{
+		const auto length = std::distance(first, last);
+		const auto minRunLength = static_cast<Difference>(leafLength);
+		auto runs = std::pmr::vector<Run>{ getMemoryResource() };
+
+		for (auto start = Difference{ 0 }; start < length; )
+		{
+			auto runStart = std::next(first, start);
+			auto runLength = nextRunLength(runStart, last, lessThan);
+
+			if (runLength < minRunLength)
 			{
-				insertFromRightPart();
+				runLength = std::min(minRunLength, length - start);
+				sortLeaf(runStart, std::next(runStart, runLength), lessThan);
 			}
+
+			runs.push_back({ start, runLength });
+			collapseRuns(runs, first, scratch, false, lessThan);
+			start += runLength;
 		}
+
+		collapseRuns(runs, first, scratch, true, lessThan);
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	inline bool MergeSorter<RandomAccessIt, lowerBound>::isLeftPartExhausted() const noexcept
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	auto MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::nextRunLength(Iterator first, Iterator last, CompareFn lessThan) -> Difference
 	{
-		return left >= middle;
+		auto current = std::next(first);
+		if (current == last)
+		{
+			return 1;
+		}
+
+		//only strictly descending runs are reversed to keep the sort stable
+		if (lessThan(*current, *first))
+		{
+			while (std::next(current) != last && lessThan(*std::next(current), *current))
+			{
+				++current;
+			}
+
+			std::reverse(first, ++current);
+		}
+		else
+		{
+			while (std::next(current) != last && !lessThan(*std::next(current), *current))
+			{
+				++current;
+			}
+
+			++current;
+		}
+
+		return std::distance(first, current);
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	inline bool MergeSorter<RandomAccessIt, lowerBound>::isRightPartExhausted() const noexcept
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::collapseRuns(std::pmr::vector<Run>& runs, Iterator first, Scratch scratch, bool force, CompareFn lessThan)
 	{
-		return right >= length;
+		auto lengthAt = [&runs](auto i) { return runs[i].length; };
+
+		//keeps len[i - 2] > len[i - 1] + len[i] and len[i - 1] > len[i]
+		//for the top runs, so the stack stays logarithmic and merges balanced
+		while (runs.size() > 1)
+		{
+			auto n = runs.size() - 2;
+
+			if (force)
+			{
+				if (n > 0 && lengthAt(n - 1) < lengthAt(n + 1))
+				{
+					--n;
+				}
+			}
+			else if ((n > 0 && lengthAt(n - 1) <= lengthAt(n) + lengthAt(n + 1)) ||
+					 (n > 1 && lengthAt(n - 2) <= lengthAt(n - 1) + lengthAt(n)))
+			{
+				if (lengthAt(n - 1) < lengthAt(n + 1))
+				{
+					--n;
+				}
+			}
+			else if (lengthAt(n) > lengthAt(n + 1))
+			{
+				break;
+			}
+
+			auto& lower = runs[n];
+			auto& upper = runs[n + 1];
+			auto runFirst = std::next(first, lower.start);
+			auto runMiddle = std::next(runFirst, lower.length);
+
+			mergeRuns(runFirst, runMiddle, std::next(runMiddle, upper.length), scratch, lessThan);
+
+			lower.length += upper.length;
+			runs.erase(std::next(std::begin(runs), n + 1));
+		}
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	template <typename CompareFn>
-	inline bool MergeSorter<RandomAccessIt, lowerBound>::rightPointsToSmallerItem(CompareFn lessThan) const
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeRuns(Iterator first, Iterator middle, Iterator last, Scratch scratch, CompareFn lessThan)
 	{
-		return lessThan(*(first + right), *(first + left));
+		auto lessOrEqual = [lessThan](const auto& lhs, const auto& rhs) { return !lessThan(rhs, lhs); };
+
+		//items of the lower run not greater than the first upper item 
+		//and items of the upper run not less than the last lower item are in place
+		first = gallop(first, middle, *middle, lessOrEqual);
+		if (first == middle)
+		{
+			skippedMergesCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		last = gallop(middle, last, *std::prev(middle), lessThan);
+
+		if (lessThan(*std::prev(last), *first))
+		{
+			rotationsCount.fetch_add(1, std::memory_order_relaxed);
+			rotateRuns(first, middle, last, scratch);
+			return;
+		}
+
+		mergesCount.fetch_add(1, std::memory_order_relaxed);
+		mergeAdaptive(first, middle, last, scratch, lessThan);
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	inline void MergeSorter<RandomAccessIt, lowerBound>::insertFromLeftPart()
+	//the shorter run is moved through the scratch if it fits,
+	//otherwise the runs are rotated in place without recursion
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::rotateRuns(Iterator first, Iterator middle, Iterator last, Scratch scratch)
 	{
-		insertFrom(left);
+		const auto length1 = std::distance(first, middle);
+		const auto length2 = std::distance(middle, last);
+		const auto bufferLength = std::min(length1, length2);
+
+		if (bufferLength > scratch.size)
+		{
+			std::rotate(first, middle, last);
+			return;
+		}
+
+		auto bufferFirst = scratch.items;
+		auto bufferLast = scratch.items + bufferLength;
+		auto x = CallOnDestruction{ [bufferFirst, bufferLast]() noexcept
+		{
+			if constexpr (!std::is_trivially_copyable_v<Item>)
+			{
+				std::destroy(bufferFirst, bufferLast);
+			}
+		} };
+
+		if (length1 <= length2)
+		{
+			std::uninitialized_move(first, middle, bufferFirst);
+			std::move(bufferFirst, bufferLast, std::move(middle, last, first));
+		}
+		else
+		{
+			std::uninitialized_move(middle, last, bufferFirst);
+			std::move_backward(first, middle, last);
+			std::move(bufferFirst, bufferLast, first);
+		}
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	inline void MergeSorter<RandomAccessIt, lowerBound>::insertFromRightPart()
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::sortInPlace(Iterator first, Iterator last, Scratch scratch, CompareFn lessThan)
 	{
-		insertFrom(right);
+		if (auto length = std::distance(first, last);
+			length <= static_cast<Difference>(leafLength))
+		{
+			sortLeaf(first, last, lessThan);
+		}
+		else
+		{
+			auto middle = std::next(first, length / 2);
+
+			//parallel halves get separate parts of the scratch, the merge gets all of it
+			auto lowerScratch = Scratch{ scratch.items, scratch.size / 2 };
+			auto upperScratch = Scratch{ scratch.items + lowerScratch.size, scratch.size - lowerScratch.size };
+			auto sortLowerHalf = [=]() { sortInPlace(first, middle, lowerScratch, lessThan); };
+			auto sortUpperHalf = [=]() { sortInPlace(middle, last, upperScratch, lessThan); };
+
+			if (length <= sequentialCutoff)
+			{
+				sortInPlace(first, middle, scratch, lessThan);
+				sortInPlace(middle, last, scratch, lessThan);
+			}
+			else
+			{
+				runInParallel(sortLowerHalf, sortUpperHalf);
+			}
+
+			if (!lessThan(*middle, *std::prev(middle)))
+			{
+				skippedMergesCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			else if (lessThan(*std::prev(last), *first))
+			{
+				rotationsCount.fetch_add(1, std::memory_order_relaxed);
+				rotateRuns(first, middle, last, scratch);
+			}
+			else
+			{
+				mergesCount.fetch_add(1, std::memory_order_relaxed);
+				mergeAdaptive(first, middle, last, scratch, lessThan);
+			}
+		}
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	inline void MergeSorter<RandomAccessIt, lowerBound>::insertFrom(Difference& partIndex)
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeAdaptive(Iterator first, Iterator middle, Iterator last, Scratch scratch, CompareFn lessThan)
 	{
-		auto it = first + partIndex;
-		buffer.push_back(std::move_if_noexcept(*it));
-		++partIndex;
+		const auto length1 = std::distance(first, middle);
+		const auto length2 = std::distance(middle, last);
+
+		if (length1 == 0 || length2 == 0)
+		{
+			return;
+		}
+		else if (std::min(length1, length2) <= scratch.size)
+		{
+			mergeWithBuffer(first, middle, last, scratch.items, lessThan);
+			return;
+		}
+		else if (length1 + length2 == 2)
+		{
+			swapIfLess(*middle, *first, lessThan);
+			return;
+		}
+
+		//split the longer run in half and the other one at the position of the splitting item, 
+		//rotating the two inner parts leaves two independent smaller merges
+		auto cut1 = first;
+		auto cut2 = middle;
+
+		if (length1 > length2)
+		{
+			cut1 = std::next(first, length1 / 2);
+			cut2 = Algorithm::lowerBound(middle, last, *cut1, lessThan);
+		}
+		else
+		{
+			cut2 = std::next(middle, length2 / 2);
+			cut1 = Algorithm::lowerBound(first, middle, *cut2, [lessThan](const auto& item, const auto& splitter)
+			{
+				return !lessThan(splitter, item);
+			});
+		}
+
+		//one of the parts may be tiny, which a recursive rotation pays for with its depth
+		auto newMiddle = std::rotate(cut1, middle, cut2);
+
+		mergeAdaptive(first, cut1, newMiddle, scratch, lessThan);
+		mergeAdaptive(newMiddle, cut2, last, scratch, lessThan);
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	inline void MergeSorter<RandomAccessIt, lowerBound>::moveResultBack()
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeWithBuffer(Iterator first, Iterator middle, Iterator last, Item* buffer, CompareFn lessThan)
 	{
-		std::move(std::begin(buffer), std::end(buffer), first);
+		//the shorter run goes to the buffer
+		auto length1 = std::distance(first, middle);
+		auto length2 = std::distance(middle, last);
+		auto bufferFirst = buffer;
+		auto bufferLast = buffer + std::min(length1, length2);
+		auto x = CallOnDestruction{ [bufferFirst, bufferLast]() noexcept 
+		{ 
+			if constexpr (!std::is_trivially_copyable_v<Item>)
+			{
+				std::destroy(bufferFirst, bufferLast);
+			}
+		} };
+
+		if (length1 <= length2)
+		{
+			std::uninitialized_move(first, middle, buffer);
+			mergeLow(bufferFirst, bufferLast, middle, last, first, lessThan);
+		}
+		else
+		{
+			std::uninitialized_move(middle, last, buffer);
+			mergeHigh(first, middle, bufferFirst, bufferLast, last, lessThan);
+		}
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeHigh(Iterator first1, Iterator last1,
+																		   Item* bufferFirst, Item* bufferLast,
+																		   Iterator destinationLast,
+																		   CompareFn lessThan)
+	{
+		auto left = last1;
+		auto right = bufferLast;
+		auto destination = destinationLast;
+
+		//from the back, ties take the upper item so the lower one stays before it
+		while (left != first1 && right != bufferFirst)
+		{
+			if (lessThan(*std::prev(right), *std::prev(left)))
+			{
+				*--destination = std::move(*--left);
+			}
+			else
+			{
+				*--destination = std::move(*--right);
+			}
+		}
+
+		//the rest of the lower run is already in place
+		std::move_backward(bufferFirst, right, destination);
+	}
+
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename CompareFn>
+	void MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::mergeLow(Item* bufferFirst, Item* bufferLast,
+																		  Iterator first2, Iterator last2,
+																		  Iterator destination,
+																		  CompareFn lessThan)
+	{
+		auto lessOrEqual = [lessThan](const auto& lhs, const auto& rhs) { return !lessThan(rhs, lhs); };
+		auto left = bufferFirst;
+		auto right = first2;
+
+		while (left != bufferLast && right != last2)
+		{
+			auto leftWins = Difference{ 0 };
+			auto rightWins = Difference{ 0 };
+
+			while (left != bufferLast && right != last2 &&
+				   leftWins < minGallop && rightWins < minGallop)
+			{
+				if (lessThan(*right, *left))
+				{
+					*destination = std::move(*right);
+					++right;
+					++rightWins;
+					leftWins = 0;
+				}
+				else
+				{
+					*destination = std::move(*left);
+					++left;
+					++leftWins;
+					rightWins = 0;
+				}
+
+				++destination;
+			}
+
+			//once a side keeps winning, move its whole streak at once
+			if (left == bufferLast || right == last2)
+			{
+				break;
+			}
+			else if (leftWins == minGallop)
+			{
+				auto streakEnd = gallop(left, bufferLast, *right, lessOrEqual);
+				destination = moveItems(left, streakEnd, destination);
+				left = streakEnd;
+			}
+			else
+			{
+				auto streakEnd = gallop(right, last2, *left, lessThan);
+				destination = std::move(right, streakEnd, destination);
+				right = streakEnd;
+			}
+		}
+
+		//the rest of the upper run is already in place
+		moveItems(left, bufferLast, destination);
 	}
 
-	template <typename RandomAccessIt, std::size_t lowerBound>
-	inline void MergeSorter<RandomAccessIt, lowerBound>::clear() noexcept
+	template <typename RandomAccessIt, std::size_t lowerBound, std::size_t parallelGrain, typename LeafSorter>
+	template <typename Iterator, typename T, typename CompareFn>
+	Iterator MergeSorter<RandomAccessIt, lowerBound, parallelGrain, LeafSorter>::gallop(Iterator first, Iterator last, const T& value, CompareFn lessThan)
 	{
-		buffer.clear();
+		const auto length = std::distance(first, last);
+		auto bound = Difference{ 1 };
+
+		while (bound <= length && lessThan(*std::next(first, bound - 1), value))
+		{
+			bound *= 2;
+		}
+
+		return Algorithm::lowerBound(std::next(first, bound / 2), 
+									 std::next(first, std::min(bound, length)),
+									 value,
+									 lessThan);
 	}
-}
\ No newline at end of file
+}
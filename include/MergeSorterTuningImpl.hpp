@@ -0,0 +1,189 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cctype>
+
+namespace IDragnev::Algorithm
+{
+	namespace Detail
+	{
+		//the best of a few runs is the least disturbed by other work on the machine
+		template <typename Item, typename CompareFn>
+		std::chrono::nanoseconds timeSorts(const std::vector<Item>& sample, CompareFn lessThan, ThreadPool& pool, const MergeSorterTuning& tuning)
+		{
+			constexpr auto repetitions = 3;
+			auto best = std::chrono::nanoseconds::max();
+			auto sorter = MergeSorter<typename std::vector<Item>::iterator>{ pool };
+			sorter.setTuning(tuning);
+
+			for (auto i = 0; i < repetitions; ++i)
+			{
+				auto items = sample;
+				const auto start = std::chrono::steady_clock::now();
+				sorter(std::begin(items), std::end(items), lessThan);
+				const auto time = std::chrono::steady_clock::now() - start;
+
+				best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+			}
+
+			return best;
+		}
+
+		inline const char* toString(MergeStrategy strategy) noexcept
+		{
+			return (strategy == MergeStrategy::natural) ? "natural" : "balanced";
+		}
+
+		inline std::optional<MergeStrategy> parseStrategy(const std::string& name) noexcept
+		{
+			if (name == "balanced")
+			{
+				return MergeStrategy::balanced;
+			}
+			else if (name == "natural")
+			{
+				return MergeStrategy::natural;
+			}
+			else
+			{
+				return std::nullopt;
+			}
+		}
+
+		inline void validateProfile(const std::string& profile)
+		{
+			if (profile.empty() || std::any_of(std::begin(profile), std::end(profile), [](unsigned char c) { return std::isspace(c); }))
+			{
+				throw std::invalid_argument{ "Tuning profiles must be non-empty and have no whitespace" };
+			}
+		}
+
+		//lines of other profiles, blank lines and comments starting with # are kept as they are
+		inline std::vector<std::string> readTuningLines(const std::filesystem::path& file)
+		{
+			auto lines = std::vector<std::string>{};
+			auto stream = std::ifstream{ file };
+
+			for (auto line = std::string{}; std::getline(stream, line); )
+			{
+				lines.push_back(std::move(line));
+			}
+
+			return lines;
+		}
+
+		inline std::string profileOf(const std::string& line)
+		{
+			auto profile = std::string{};
+			std::istringstream{ line } >> profile;
+
+			return (!profile.empty() && profile.front() == '#') ? std::string{} : profile;
+		}
+	}
+
+	template <typename Item, typename CompareFn>
+	MergeSorterTuning autotuneMergeSorter(const std::vector<Item>& sample, CompareFn lessThan, ThreadPool& pool)
+	{
+		const auto length = sample.size();
+		auto best = MergeSorterTuning{};
+		auto bestTime = Detail::timeSorts(sample, lessThan, pool, best);
+
+		auto tryCandidate = [&](const MergeSorterTuning& candidate)
+		{
+			if (auto time = Detail::timeSorts(sample, lessThan, pool, candidate);
+				time < bestTime)
+			{
+				best = candidate;
+				bestTime = time;
+			}
+		};
+
+		for (auto leafLength : { 4, 8, 12, 16, 24, 32, 48, 64, 96 })
+		{
+			auto candidate = best;
+			candidate.leafLength = leafLength;
+			tryCandidate(candidate);
+		}
+
+		//a grain of the whole sample sorts it on one thread
+		for (auto parts : { 256, 64, 16, 4, 1 })
+		{
+			if (auto grain = length / parts;
+				grain > best.leafLength)
+			{
+				auto candidate = best;
+				candidate.parallelGrain = grain;
+				tryCandidate(candidate);
+			}
+		}
+
+		auto candidate = best;
+		candidate.strategy = (best.strategy == MergeStrategy::natural) ? MergeStrategy::balanced : MergeStrategy::natural;
+		tryCandidate(candidate);
+
+		return best;
+	}
+
+	inline void saveTuning(const std::filesystem::path& file, const std::string& profile, const MergeSorterTuning& tuning)
+	{
+		Detail::validateProfile(profile);
+
+		auto entry = std::ostringstream{};
+		entry << profile << ' ' << tuning.leafLength << ' ' << tuning.parallelGrain << ' ' << Detail::toString(tuning.strategy);
+
+		auto lines = Detail::readTuningLines(file);
+		auto existing = std::find_if(std::begin(lines), std::end(lines), [&profile](const std::string& line) { return Detail::profileOf(line) == profile; });
+
+		if (existing != std::end(lines))
+		{
+			*existing = entry.str();
+		}
+		else
+		{
+			lines.push_back(entry.str());
+		}
+
+		auto stream = std::ofstream{ file, std::ios::trunc };
+		for (const auto& line : lines)
+		{
+			stream << line << '\n';
+		}
+
+		if (!stream.flush())
+		{
+			throw std::runtime_error{ "Failed to write " + file.string() };
+		}
+	}
+
+	//a missing file or profile is not an error, there is just no tuning for it yet
+	inline std::optional<MergeSorterTuning> loadTuning(const std::filesystem::path& file, const std::string& profile)
+	{
+		Detail::validateProfile(profile);
+
+		for (const auto& line : Detail::readTuningLines(file))
+		{
+			if (Detail::profileOf(line) == profile)
+			{
+				auto stream = std::istringstream{ line };
+				auto name = std::string{};
+				auto strategy = std::string{};
+				auto tuning = MergeSorterTuning{};
+
+				stream >> name >> tuning.leafLength >> tuning.parallelGrain >> strategy;
+				auto parsedStrategy = Detail::parseStrategy(strategy);
+
+				if (!stream || !parsedStrategy)
+				{
+					throw std::runtime_error{ "Malformed tuning of " + profile + " in " + file.string() };
+				}
+
+				tuning.strategy = *parsedStrategy;
+				return tuning;
+			}
+		}
+
+		return std::nullopt;
+	}
+}
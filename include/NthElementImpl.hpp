@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cmath>
+
+namespace IDragnev::Algorithm
+{
+	namespace Detail
+	{
+		//shorter ranges are sorted instead
+		inline constexpr std::ptrdiff_t selectionSortLength = 16;
+
+		//longer ranges take their pivot from a sample around the searched position
+		inline constexpr std::ptrdiff_t floydRivestLength = 600;
+
+		//partial sorts of more than that part of the range select first and sort after
+		inline constexpr std::ptrdiff_t partialSortSelectRatio = 8;
+
+		template <typename RandomAccessIt, typename CompareFn>
+		void selectWithMedianOfMedians(RandomAccessIt first, RandomAccessIt nth, RandomAccessIt last, CompareFn lessThan);
+
+		//splits the range into the items less than the pivot, equal to it and greater
+		//than it, returning where the equal ones start and end
+		template <typename RandomAccessIt, typename CompareFn>
+		auto partitionAround(RandomAccessIt first, RandomAccessIt last, RandomAccessIt pivot, CompareFn lessThan)
+			-> std::pair<RandomAccessIt, RandomAccessIt>
+		{
+			std::iter_swap(first, pivot);
+
+			auto less = first + 1;
+			auto greater = last;
+			for (auto current = first + 1; current != greater; )
+			{
+				if (lessThan(*current, *first))
+				{
+					std::iter_swap(less++, current++);
+				}
+				else if (lessThan(*first, *current))
+				{
+					std::iter_swap(current, --greater);
+				}
+				else
+				{
+					++current;
+				}
+			}
+
+			std::iter_swap(first, --less);
+
+			return { less, greater };
+		}
+
+		template <typename RandomAccessIt, typename CompareFn>
+		void moveMedianOfThree(RandomAccessIt a, RandomAccessIt middle, RandomAccessIt b, CompareFn lessThan)
+		{
+			if (lessThan(*middle, *a))
+			{
+				std::iter_swap(middle, a);
+			}
+			if (lessThan(*b, *middle))
+			{
+				std::iter_swap(b, middle);
+			}
+			if (lessThan(*middle, *a))
+			{
+				std::iter_swap(middle, a);
+			}
+		}
+
+		//a pivot with at least 3/10 of the items on either side
+		template <typename RandomAccessIt, typename CompareFn>
+		RandomAccessIt medianOfMedians(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+		{
+			constexpr auto groupLength = std::ptrdiff_t{ 5 };
+
+			auto medians = first;
+			for (auto group = first; group < last; group += std::min(groupLength, last - group))
+			{
+				auto groupEnd = group + std::min(groupLength, last - group);
+				InsertionSorter{}(group, groupEnd, lessThan);
+				std::iter_swap(medians++, group + (groupEnd - group) / 2);
+			}
+
+			auto middle = first + (medians - first) / 2;
+			selectWithMedianOfMedians(first, middle, medians, lessThan);
+
+			return middle;
+		}
+
+		template <typename RandomAccessIt, typename CompareFn>
+		void selectWithMedianOfMedians(RandomAccessIt first, RandomAccessIt nth, RandomAccessIt last, CompareFn lessThan)
+		{
+			while (last - first > selectionSortLength)
+			{
+				auto [equalFirst, equalLast] = partitionAround(first, last, medianOfMedians(first, last, lessThan), lessThan);
+
+				if (nth < equalFirst)
+				{
+					last = equalFirst;
+				}
+				else if (nth >= equalLast)
+				{
+					first = equalLast;
+				}
+				else
+				{
+					return;
+				}
+			}
+
+			if (last - first > 1)
+			{
+				InsertionSorter{}(first, last, lessThan);
+			}
+		}
+
+		template <typename RandomAccessIt, typename CompareFn>
+		void introselect(RandomAccessIt first, RandomAccessIt nth, RandomAccessIt last, CompareFn lessThan, int badPartitionsAllowed)
+		{
+			while (last - first > selectionSortLength)
+			{
+				if (badPartitionsAllowed <= 0)
+				{
+					selectWithMedianOfMedians(first, nth, last, lessThan);
+					return;
+				}
+
+				const auto length = last - first;
+				auto pivot = first + length / 2;
+
+				if (length > floydRivestLength)
+				{
+					//an item selected from a sample of about n^(2/3) around nth is close to the
+					//searched one, so the partition around it leaves only a few items to go on with
+					const auto n = static_cast<double>(length);
+					const auto i = static_cast<double>(nth - first);
+					const auto z = std::log(n);
+					const auto s = 0.5 * std::exp(2 * z / 3);
+					const auto deviation = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+
+					auto sampleFirst = first + std::clamp(static_cast<std::ptrdiff_t>(i - i * s / n + deviation), std::ptrdiff_t{ 0 }, nth - first);
+					auto sampleLast = first + std::clamp(static_cast<std::ptrdiff_t>(i + (n - i) * s / n + deviation) + 1, nth - first + 1, length);
+
+					introselect(sampleFirst, nth, sampleLast, lessThan, badPartitionsAllowed);
+					pivot = nth;
+				}
+				else
+				{
+					moveMedianOfThree(first, pivot, last - 1, lessThan);
+				}
+
+				auto [equalFirst, equalLast] = partitionAround(first, last, pivot, lessThan);
+
+				if (nth < equalFirst)
+				{
+					last = equalFirst;
+				}
+				else if (nth >= equalLast)
+				{
+					first = equalLast;
+				}
+				else
+				{
+					return;
+				}
+
+				if (last - first > length / 4 * 3)
+				{
+					--badPartitionsAllowed;
+				}
+			}
+
+			if (last - first > 1)
+			{
+				InsertionSorter{}(first, last, lessThan);
+			}
+		}
+	}
+
+	template <typename RandomAccessIt, typename CompareFn>
+	void nthElement(RandomAccessIt first, RandomAccessIt nth, RandomAccessIt last, CompareFn lessThan)
+	{
+		if (nth == last)
+		{
+			return;
+		}
+
+		auto logLength = 0;
+		for (auto length = last - first; length > 1; length /= 2)
+		{
+			++logLength;
+		}
+
+		Detail::introselect(first, nth, last, lessThan, logLength);
+	}
+
+	template <typename RandomAccessIt, typename CompareFn>
+	void partialSort(RandomAccessIt first, RandomAccessIt middle, RandomAccessIt last, CompareFn lessThan)
+	{
+		const auto length = last - first;
+		const auto count = middle - first;
+
+		if (count == 0)
+		{
+			return;
+		}
+		else if (count > length / Detail::partialSortSelectRatio)
+		{
+			nthElement(first, middle - 1, last, lessThan);
+			QuickSorter{}(first, middle - 1, lessThan);
+			return;
+		}
+
+		//the greatest of the items kept so far is at the top, so an item
+		//which is not less than it is rejected with a single comparison
+		makeHeap(first, middle, lessThan);
+
+		for (auto current = middle; current != last; ++current)
+		{
+			if (lessThan(*current, *first))
+			{
+				std::iter_swap(current, first);
+				Detail::siftDown<2>(first, count, 0, lessThan);
+			}
+		}
+
+		QuickSorter{}(first, middle, lessThan);
+	}
+
+	template <typename InputIt, typename RandomAccessIt, typename CompareFn>
+	RandomAccessIt partialSortCopy(InputIt first, InputIt last, RandomAccessIt destFirst, RandomAccessIt destLast, CompareFn lessThan)
+	{
+		auto destEnd = destFirst;
+		for (; first != last && destEnd != destLast; ++first, ++destEnd)
+		{
+			*destEnd = *first;
+		}
+
+		const auto count = destEnd - destFirst;
+		if (count == 0)
+		{
+			return destEnd;
+		}
+
+		makeHeap(destFirst, destEnd, lessThan);
+
+		for (; first != last; ++first)
+		{
+			if (lessThan(*first, *destFirst))
+			{
+				*destFirst = *first;
+				Detail::siftDown<2>(destFirst, count, 0, lessThan);
+			}
+		}
+
+		QuickSorter{}(destFirst, destEnd, lessThan);
+
+		return destEnd;
+	}
+}
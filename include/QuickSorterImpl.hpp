@@ -0,0 +1,427 @@
+#pragma once
+
+namespace IDragnev::Algorithm
+{
+	template <typename RandomAccessIt, typename CompareFn>
+	void QuickSorter::operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) const
+	{
+		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
+
+		//comparisons of arithmetic keys are cheap enough to always do, a mispredicted branch is not
+		constexpr auto branchless = std::is_arithmetic_v<Item> && Detail::isPlainOrdering<Item, CompareFn>;
+
+		auto length = std::distance(first, last);
+		auto depthLog = 0;
+		while (length > 1)
+		{
+			length /= 2;
+			++depthLog;
+		}
+
+		sortLoop<branchless>(first, last, lessThan, depthLog, true);
+	}
+
+	template <bool branchless, typename RandomAccessIt, typename CompareFn>
+	void QuickSorter::sortLoop(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan, int badPartitionsAllowed, bool isLeftmost)
+	{
+		while (true)
+		{
+			const auto length = std::distance(first, last);
+			if (length < insertionSortLength)
+			{
+				if (length > 1)
+				{
+					InsertionSorter{}(first, last, lessThan);
+				}
+
+				return;
+			}
+
+			//the pivot goes to the front
+			const auto half = length / 2;
+			if (length > nintherLength)
+			{
+				sort3(first, first + half, last - 1, lessThan);
+				sort3(first + 1, first + (half - 1), last - 2, lessThan);
+				sort3(first + 2, first + (half + 1), last - 3, lessThan);
+				sort3(first + (half - 1), first + half, first + (half + 1), lessThan);
+				std::iter_swap(first, first + half);
+			}
+			else
+			{
+				sort3(first + half, first, last - 1, lessThan);
+			}
+
+			//the item before the range is not greater than any in it, so a pivot equal to it
+			//is the smallest item and everything equal to it is already in place
+			if (!isLeftmost && !lessThan(*(first - 1), *first))
+			{
+				first = partitionLeft(first, last, lessThan) + 1;
+				continue;
+			}
+
+			auto [pivot, wasPartitioned] = branchless ? partitionRightBranchless(first, last, lessThan)
+													  : partitionRight(first, last, lessThan);
+
+			const auto leftLength = std::distance(first, pivot);
+			const auto rightLength = std::distance(pivot + 1, last);
+
+			if (leftLength < length / 8 || rightLength < length / 8)
+			{
+				if (--badPartitionsAllowed == 0)
+				{
+					heapSort(first, last, lessThan);
+					return;
+				}
+
+				//shuffling a few items breaks the patterns which led to the bad pivot
+				if (leftLength >= insertionSortLength)
+				{
+					std::iter_swap(first, first + leftLength / 4);
+					std::iter_swap(pivot - 1, pivot - leftLength / 4);
+
+					if (leftLength > nintherLength)
+					{
+						std::iter_swap(first + 1, first + (leftLength / 4 + 1));
+						std::iter_swap(first + 2, first + (leftLength / 4 + 2));
+						std::iter_swap(pivot - 2, pivot - (leftLength / 4 + 1));
+						std::iter_swap(pivot - 3, pivot - (leftLength / 4 + 2));
+					}
+				}
+
+				if (rightLength >= insertionSortLength)
+				{
+					std::iter_swap(pivot + 1, pivot + (1 + rightLength / 4));
+					std::iter_swap(last - 1, last - rightLength / 4);
+
+					if (rightLength > nintherLength)
+					{
+						std::iter_swap(pivot + 2, pivot + (2 + rightLength / 4));
+						std::iter_swap(pivot + 3, pivot + (3 + rightLength / 4));
+						std::iter_swap(last - 2, last - (1 + rightLength / 4));
+						std::iter_swap(last - 3, last - (2 + rightLength / 4));
+					}
+				}
+			}
+			else if (wasPartitioned &&
+					 partialInsertionSort(first, pivot, lessThan) &&
+					 partialInsertionSort(pivot + 1, last, lessThan))
+			{
+				return;
+			}
+
+			sortLoop<branchless>(first, pivot, lessThan, badPartitionsAllowed, isLeftmost);
+			first = pivot + 1;
+			isLeftmost = false;
+		}
+	}
+
+	//items equal to the pivot go to the right,
+	//the second result tells if no items had to be swapped
+	template <typename RandomAccessIt, typename CompareFn>
+	auto QuickSorter::partitionRight(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) -> std::pair<RandomAccessIt, bool>
+	{
+		auto pivot = std::move(*first);
+		auto left = first;
+		auto right = last;
+
+		//the median of three leaves an item not less than the pivot on the right
+		while (lessThan(*++left, pivot));
+
+		if (left - 1 == first)
+		{
+			while (left < right && !lessThan(*--right, pivot));
+		}
+		else
+		{
+			while (!lessThan(*--right, pivot));
+		}
+
+		const auto wasPartitioned = left >= right;
+
+		while (left < right)
+		{
+			std::iter_swap(left, right);
+			while (lessThan(*++left, pivot));
+			while (!lessThan(*--right, pivot));
+		}
+
+		auto pivotPosition = left - 1;
+		*first = std::move(*pivotPosition);
+		*pivotPosition = std::move(pivot);
+
+		return { pivotPosition, wasPartitioned };
+	}
+
+	//the same partition with the comparisons of a block of items stored as offsets
+	//of the misplaced ones, which are then swapped in pairs across the two sides
+	template <typename RandomAccessIt, typename CompareFn>
+	auto QuickSorter::partitionRightBranchless(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) -> std::pair<RandomAccessIt, bool>
+	{
+		auto pivot = std::move(*first);
+		auto left = first;
+		auto right = last;
+
+		while (lessThan(*++left, pivot));
+
+		if (left - 1 == first)
+		{
+			while (left < right && !lessThan(*--right, pivot));
+		}
+		else
+		{
+			while (!lessThan(*--right, pivot));
+		}
+
+		const auto wasPartitioned = left >= right;
+
+		if (!wasPartitioned)
+		{
+			std::iter_swap(left, right);
+			++left;
+
+			alignas(64) unsigned char leftOffsets[blockLength];
+			alignas(64) unsigned char rightOffsets[blockLength];
+			auto leftCount = std::size_t{ 0 };
+			auto rightCount = std::size_t{ 0 };
+			auto leftStart = std::size_t{ 0 };
+			auto rightStart = std::size_t{ 0 };
+
+			auto fillLeft = [&](std::ptrdiff_t length)
+			{
+				leftStart = 0;
+				auto current = left;
+				for (auto i = std::ptrdiff_t{ 0 }; i < length; ++i, ++current)
+				{
+					leftOffsets[leftCount] = static_cast<unsigned char>(i);
+					leftCount += !lessThan(*current, pivot);
+				}
+			};
+			auto fillRight = [&](std::ptrdiff_t length)
+			{
+				rightStart = 0;
+				auto current = right;
+				for (auto i = std::ptrdiff_t{ 0 }; i < length; )
+				{
+					rightOffsets[rightCount] = static_cast<unsigned char>(++i);
+					rightCount += lessThan(*--current, pivot);
+				}
+			};
+			auto swapFound = [&]()
+			{
+				auto count = std::min(leftCount, rightCount);
+				swapOffsets(left, right, leftOffsets + leftStart, rightOffsets + rightStart, count, leftCount == rightCount);
+				leftCount -= count;
+				rightCount -= count;
+				leftStart += count;
+				rightStart += count;
+			};
+
+			//[left, right) holds the items not compared yet
+			while (right - left > 2 * blockLength)
+			{
+				if (leftCount == 0)
+				{
+					fillLeft(blockLength);
+				}
+				if (rightCount == 0)
+				{
+					fillRight(blockLength);
+				}
+
+				swapFound();
+
+				if (leftCount == 0)
+				{
+					left += blockLength;
+				}
+				if (rightCount == 0)
+				{
+					right -= blockLength;
+				}
+			}
+
+			//the rest is split between the sides which have no offsets left
+			auto unknownLength = (right - left) - ((leftCount > 0 || rightCount > 0) ? blockLength : 0);
+			auto leftLength = std::ptrdiff_t{ 0 };
+			auto rightLength = std::ptrdiff_t{ 0 };
+
+			if (rightCount > 0)
+			{
+				leftLength = unknownLength;
+				rightLength = blockLength;
+			}
+			else if (leftCount > 0)
+			{
+				leftLength = blockLength;
+				rightLength = unknownLength;
+			}
+			else
+			{
+				leftLength = unknownLength / 2;
+				rightLength = unknownLength - leftLength;
+			}
+
+			if (unknownLength > 0 && leftCount == 0)
+			{
+				fillLeft(leftLength);
+			}
+			if (unknownLength > 0 && rightCount == 0)
+			{
+				fillRight(rightLength);
+			}
+
+			swapFound();
+
+			if (leftCount == 0)
+			{
+				left += leftLength;
+			}
+			if (rightCount == 0)
+			{
+				right -= rightLength;
+			}
+
+			//the misplaced items of one side are left, they go to the far end of the other
+			if (leftCount > 0)
+			{
+				while (leftCount-- > 0)
+				{
+					std::iter_swap(left + leftOffsets[leftStart + leftCount], --right);
+				}
+				left = right;
+			}
+			if (rightCount > 0)
+			{
+				while (rightCount-- > 0)
+				{
+					std::iter_swap(right - rightOffsets[rightStart + rightCount], left);
+					++left;
+				}
+				right = left;
+			}
+		}
+
+		auto pivotPosition = left - 1;
+		*first = std::move(*pivotPosition);
+		*pivotPosition = std::move(pivot);
+
+		return { pivotPosition, wasPartitioned };
+	}
+
+	//unequal counts of offsets are swapped with a cycle of moves
+	template <typename RandomAccessIt>
+	void QuickSorter::swapOffsets(RandomAccessIt first, RandomAccessIt last, const unsigned char* leftOffsets, const unsigned char* rightOffsets, std::size_t count, bool useSwaps)
+	{
+		if (useSwaps)
+		{
+			for (auto i = std::size_t{ 0 }; i < count; ++i)
+			{
+				std::iter_swap(first + leftOffsets[i], last - rightOffsets[i]);
+			}
+		}
+		else if (count > 0)
+		{
+			auto left = first + leftOffsets[0];
+			auto right = last - rightOffsets[0];
+			auto item = std::move(*left);
+			*left = std::move(*right);
+
+			for (auto i = std::size_t{ 1 }; i < count; ++i)
+			{
+				left = first + leftOffsets[i];
+				*right = std::move(*left);
+				right = last - rightOffsets[i];
+				*left = std::move(*right);
+			}
+
+			*right = std::move(item);
+		}
+	}
+
+	//items equal to the pivot go to the left
+	template <typename RandomAccessIt, typename CompareFn>
+	RandomAccessIt QuickSorter::partitionLeft(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		auto pivot = std::move(*first);
+		auto left = first;
+		auto right = last;
+
+		while (lessThan(pivot, *--right));
+
+		if (right + 1 == last)
+		{
+			while (left < right && !lessThan(pivot, *++left));
+		}
+		else
+		{
+			while (!lessThan(pivot, *++left));
+		}
+
+		while (left < right)
+		{
+			std::iter_swap(left, right);
+			while (lessThan(pivot, *--right));
+			while (!lessThan(pivot, *++left));
+		}
+
+		*first = std::move(*right);
+		*right = std::move(pivot);
+
+		return right;
+	}
+
+	//returns false if the range could not be sorted within a few moves
+	template <typename RandomAccessIt, typename CompareFn>
+	bool QuickSorter::partialInsertionSort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan)
+	{
+		if (first == last)
+		{
+			return true;
+		}
+
+		auto movesCount = std::ptrdiff_t{ 0 };
+
+		for (auto current = first + 1; current != last; ++current)
+		{
+			if (lessThan(*current, *(current - 1)))
+			{
+				auto item = std::move(*current);
+				auto emptyPos = current;
+
+				do
+				{
+					*emptyPos = std::move(*(emptyPos - 1));
+					--emptyPos;
+				} while (emptyPos != first && lessThan(item, *(emptyPos - 1)));
+
+				*emptyPos = std::move(item);
+				movesCount += current - emptyPos;
+
+				if (movesCount > partialInsertionSortLimit)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	template <typename RandomAccessIt, typename CompareFn>
+	inline void QuickSorter::sort3(RandomAccessIt a, RandomAccessIt b, RandomAccessIt c, CompareFn lessThan)
+	{
+		sort2(a, b, lessThan);
+		sort2(b, c, lessThan);
+		sort2(a, b, lessThan);
+	}
+
+	template <typename RandomAccessIt, typename CompareFn>
+	inline void QuickSorter::sort2(RandomAccessIt a, RandomAccessIt b, CompareFn lessThan)
+	{
+		if (lessThan(*b, *a))
+		{
+			std::iter_swap(a, b);
+		}
+	}
+}
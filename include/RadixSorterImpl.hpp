@@ -0,0 +1,381 @@
+#pragma once
+
+#include <cstring>
+#include <limits>
+
+namespace IDragnev::Algorithm
+{
+	namespace Detail
+	{
+		//an unsigned key which orders like the given one
+		template <typename Key>
+		auto toRadixKey(Key key) noexcept
+		{
+			static_assert(std::is_arithmetic_v<Key>, "Radix keys must be of an arithmetic type");
+
+			if constexpr (std::is_same_v<Key, bool>)
+			{
+				return static_cast<unsigned char>(key);
+			}
+			else if constexpr (std::is_floating_point_v<Key>)
+			{
+				static_assert(std::numeric_limits<Key>::is_iec559 && (sizeof(Key) == 4 || sizeof(Key) == 8),
+							  "Floating point keys must be IEEE-754 floats or doubles");
+
+				using Bits = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+				constexpr auto signBit = Bits{ 1 } << (sizeof(Bits) * 8 - 1);
+
+				auto bits = Bits{};
+				std::memcpy(&bits, &key, sizeof(Key));
+
+				//negative numbers grow in magnitude downwards
+				return static_cast<Bits>((bits & signBit) ? ~bits : (bits | signBit));
+			}
+			else
+			{
+				using Unsigned = std::make_unsigned_t<Key>;
+				constexpr auto signBit = std::is_signed_v<Key> ? static_cast<Unsigned>(Unsigned{ 1 } << (sizeof(Key) * 8 - 1)) : Unsigned{ 0 };
+
+				return static_cast<Unsigned>(static_cast<Unsigned>(key) ^ signBit);
+			}
+		}
+	}
+
+	template <std::size_t digitBits>
+	inline RadixSorter<digitBits>::RadixSorter(ThreadPool& pool, std::size_t threadsCount) noexcept :
+		pool(&pool),
+		threadsCount(threadsCount)
+	{
+	}
+
+	template <std::size_t digitBits>
+	template <typename RandomAccessIt, typename KeyFn>
+	void RadixSorter<digitBits>::operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf) const
+	{
+		auto radixKey = [keyOf](const auto& item) { return Detail::toRadixKey(keyOf(item)); };
+
+		if constexpr (isContiguousIterator<RandomAccessIt>)
+		{
+			if (first != last)
+			{
+				auto items = std::addressof(*first);
+				sort(items, items + std::distance(first, last), radixKey);
+			}
+		}
+		else
+		{
+			sort(first, last, radixKey);
+		}
+	}
+
+	template <std::size_t digitBits>
+	inline void RadixSorter<digitBits>::setMemoryResource(std::pmr::memory_resource* resource) noexcept
+	{
+		this->resource = resource;
+	}
+
+	template <std::size_t digitBits>
+	inline std::pmr::memory_resource* RadixSorter<digitBits>::getMemoryResource() const noexcept
+	{
+		return (resource != nullptr) ? resource : std::pmr::get_default_resource();
+	}
+
+	template <std::size_t digitBits>
+	inline void RadixSorter<digitBits>::setThreadsCount(std::size_t count) noexcept
+	{
+		threadsCount = count;
+	}
+
+	template <std::size_t digitBits>
+	inline std::size_t RadixSorter<digitBits>::getThreadsCount() const noexcept
+	{
+		return threadsCount;
+	}
+
+	template <std::size_t digitBits>
+	inline ThreadPool& RadixSorter<digitBits>::threadPool() const
+	{
+		return (pool != nullptr) ? *pool : ThreadPool::shared();
+	}
+
+	template <std::size_t digitBits>
+	std::size_t RadixSorter<digitBits>::threadsFor(std::size_t length) const
+	{
+		auto threads = (threadsCount > 0) ? threadsCount : threadPool().workersCount() + 1;
+		return std::max(std::min(threads, length / minChunkLength), std::size_t{ 1 });
+	}
+
+	template <std::size_t digitBits>
+	template <typename RandomAccessIt, typename RadixKeyFn>
+	void RadixSorter<digitBits>::sort(RandomAccessIt first, RandomAccessIt last, RadixKeyFn radixKey) const
+	{
+		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
+		using Key = decltype(radixKey(*first));
+
+		static_assert(std::is_nothrow_move_constructible_v<Item> && std::is_nothrow_move_assignable_v<Item>,
+					  "Items are moved between the range and the scratch buffer");
+
+		constexpr auto keyBits = sizeof(Key) * 8;
+		constexpr auto passes = (keyBits + digitBits - 1) / digitBits;
+		constexpr auto digitMask = static_cast<Key>(radix - 1);
+
+		const auto length = std::distance(first, last);
+		if (length <= insertionSortLength)
+		{
+			if (length > 1)
+			{
+				InsertionSorter{}(first, last, [radixKey](const auto& lhs, const auto& rhs) { return radixKey(lhs) < radixKey(rhs); });
+			}
+
+			return;
+		}
+
+		const auto size = static_cast<std::size_t>(length);
+		const auto threads = threadsFor(size);
+
+		auto source = getMemoryResource();
+		auto counts = std::pmr::vector<std::size_t>(passes * radix, 0, source);
+		countDigits(first, last, counts.data(), radixKey);
+
+		auto buffer = static_cast<Item*>(source->allocate(size * sizeof(Item), alignof(Item)));
+		auto isBufferConstructed = false;
+		auto x = CallOnDestruction{ [source, buffer, size, &isBufferConstructed]() noexcept
+		{
+			if constexpr (!std::is_trivially_copyable_v<Item>)
+			{
+				if (isBufferConstructed)
+				{
+					std::destroy(buffer, buffer + size);
+				}
+			}
+
+			source->deallocate(buffer, size * sizeof(Item), alignof(Item));
+		} };
+
+		auto isInBuffer = false;
+		const auto firstKey = radixKey(*first);
+
+		for (auto pass = std::size_t{ 0 }; pass < passes; ++pass)
+		{
+			const auto shift = static_cast<unsigned>(pass * digitBits);
+			auto offsets = counts.data() + pass * radix;
+
+			//a digit shared by all keys leaves the order as it is
+			if (offsets[(firstKey >> shift) & digitMask] == size)
+			{
+				continue;
+			}
+
+			if (threads > 1)
+			{
+				if (isInBuffer)
+				{
+					distributeInParallel(buffer, buffer + size, first, threads, shift, false, radixKey);
+				}
+				else
+				{
+					distributeInParallel(first, last, buffer, threads, shift, !isBufferConstructed, radixKey);
+				}
+			}
+			else
+			{
+				for (auto digit = std::size_t{ 0 }, sum = std::size_t{ 0 }; digit < radix; ++digit)
+				{
+					auto count = offsets[digit];
+					offsets[digit] = sum;
+					sum += count;
+				}
+
+				if (isInBuffer)
+				{
+					scatter(buffer, buffer + size, first, offsets, shift, false, radixKey);
+				}
+				else
+				{
+					scatter(first, last, buffer, offsets, shift, !isBufferConstructed, radixKey);
+				}
+			}
+
+			isBufferConstructed = true;
+			isInBuffer = !isInBuffer;
+		}
+
+		if (isInBuffer)
+		{
+			std::move(buffer, buffer + size, first);
+		}
+	}
+
+	//all digit counts are taken in a single read of the keys
+	template <std::size_t digitBits>
+	template <typename RandomAccessIt, typename RadixKeyFn>
+	void RadixSorter<digitBits>::countDigits(RandomAccessIt first, RandomAccessIt last, std::size_t* counts, RadixKeyFn radixKey) const
+	{
+		using Key = decltype(radixKey(*first));
+		constexpr auto passes = (sizeof(Key) * 8 + digitBits - 1) / digitBits;
+		constexpr auto digitMask = static_cast<Key>(radix - 1);
+
+		auto count = [radixKey](RandomAccessIt first, RandomAccessIt last, std::size_t* counts)
+		{
+			for (; first != last; ++first)
+			{
+				auto key = radixKey(*first);
+
+				for (auto pass = std::size_t{ 0 }; pass < passes; ++pass)
+				{
+					++counts[pass * radix + ((key >> (pass * digitBits)) & digitMask)];
+				}
+			}
+		};
+
+		const auto size = static_cast<std::size_t>(std::distance(first, last));
+		const auto threads = threadsFor(size);
+		if (threads == 1)
+		{
+			count(first, last, counts);
+			return;
+		}
+
+		//each thread counts into its own histogram and they are summed up after
+		auto histograms = std::pmr::vector<std::pmr::vector<std::size_t>>(threads, getMemoryResource());
+		threadPool().forEachIndex(threads, [&](std::size_t thread)
+		{
+			auto& histogram = histograms[thread];
+			histogram.assign(passes * radix, 0);
+			count(std::next(first, size * thread / threads), std::next(first, size * (thread + 1) / threads), histogram.data());
+		});
+
+		for (const auto& histogram : histograms)
+		{
+			std::transform(std::begin(histogram), std::end(histogram), counts, counts, std::plus{});
+		}
+	}
+
+	template <std::size_t digitBits>
+	template <typename SourceIt, typename DestIt, typename RadixKeyFn>
+	void RadixSorter<digitBits>::distributeInParallel(SourceIt first, SourceIt last, DestIt destination, std::size_t threads, unsigned shift, bool construct, RadixKeyFn radixKey) const
+	{
+		using Item = typename std::iterator_traits<SourceIt>::value_type;
+		using Key = decltype(radixKey(*first));
+		constexpr auto digitMask = static_cast<Key>(radix - 1);
+
+		const auto size = static_cast<std::size_t>(std::distance(first, last));
+		auto chunkStart = [first, size, threads](std::size_t thread) { return std::next(first, size * thread / threads); };
+
+		auto source = getMemoryResource();
+		auto histograms = std::pmr::vector<std::pmr::vector<std::size_t>>(threads, source);
+		threadPool().forEachIndex(threads, [&](std::size_t thread)
+		{
+			auto& histogram = histograms[thread];
+			histogram.assign(radix, 0);
+
+			for (auto current = chunkStart(thread); current != chunkStart(thread + 1); ++current)
+			{
+				++histogram[(radixKey(*current) >> shift) & digitMask];
+			}
+		});
+
+		//the items of a digit go in the order of the chunks, which keeps the sort stable
+		auto counts = std::pmr::vector<std::size_t>(radix * threads, source);
+		for (auto digit = std::size_t{ 0 }; digit < radix; ++digit)
+		{
+			for (auto thread = std::size_t{ 0 }; thread < threads; ++thread)
+			{
+				counts[digit * threads + thread] = histograms[thread][digit];
+			}
+		}
+
+		auto offsets = std::pmr::vector<std::size_t>(radix * threads, source);
+		exclusiveScan(std::begin(counts), std::end(counts), std::begin(offsets), std::size_t{ 0 }, std::plus{});
+
+		for (auto digit = std::size_t{ 0 }; digit < radix; ++digit)
+		{
+			for (auto thread = std::size_t{ 0 }; thread < threads; ++thread)
+			{
+				histograms[thread][digit] = offsets[digit * threads + thread];
+			}
+		}
+
+		threadPool().forEachIndex(threads, [&](std::size_t thread)
+		{
+			auto chunkFirst = chunkStart(thread);
+			auto chunkLast = chunkStart(thread + 1);
+			auto chunkOffsets = histograms[thread].data();
+
+			if constexpr (std::is_trivially_copyable_v<Item> && std::is_pointer_v<DestIt> &&
+						  sizeof(Item) * 2 <= cacheLineBytes && digitBits <= 11)
+			{
+				scatterCombined(chunkFirst, chunkLast, destination, chunkOffsets, shift, radixKey);
+			}
+			else
+			{
+				scatter(chunkFirst, chunkLast, destination, chunkOffsets, shift, construct, radixKey);
+			}
+		});
+	}
+
+	template <std::size_t digitBits>
+	template <typename SourceIt, typename DestIt, typename RadixKeyFn>
+	void RadixSorter<digitBits>::scatter(SourceIt first, SourceIt last, DestIt destination, std::size_t* offsets, unsigned shift, bool construct, RadixKeyFn radixKey)
+	{
+		using Item = typename std::iterator_traits<SourceIt>::value_type;
+		using Key = decltype(radixKey(*first));
+		constexpr auto digitMask = static_cast<Key>(radix - 1);
+
+		for (; first != last; ++first)
+		{
+			auto& position = offsets[(radixKey(*first) >> shift) & digitMask];
+			auto target = std::addressof(destination[position++]);
+
+			if (construct && !std::is_trivially_copyable_v<Item>)
+			{
+				::new (static_cast<void*>(target)) Item(std::move(*first));
+			}
+			else
+			{
+				*target = std::move(*first);
+			}
+		}
+	}
+
+	//threads writing to a few hundred places each compete for the memory bus and 
+	//miss the TLB on almost every item, so the items are gathered by digit and 
+	//written a line at a time. A single thread is better off without it
+	template <std::size_t digitBits>
+	template <typename SourceIt, typename Item, typename RadixKeyFn>
+	void RadixSorter<digitBits>::scatterCombined(SourceIt first, SourceIt last, Item* destination, std::size_t* offsets, unsigned shift, RadixKeyFn radixKey) const
+	{
+		using Key = decltype(radixKey(*first));
+		constexpr auto digitMask = static_cast<Key>(radix - 1);
+		constexpr auto blockLength = cacheLineBytes / sizeof(Item);
+		constexpr auto blocksBytes = radix * blockLength * sizeof(Item);
+		constexpr auto blocksAlignment = std::max(alignof(Item), cacheLineBytes);
+
+		auto source = getMemoryResource();
+		auto blocks = static_cast<Item*>(source->allocate(blocksBytes, blocksAlignment));
+		auto x = CallOnDestruction{ [source, blocks]() noexcept { source->deallocate(blocks, blocksBytes, blocksAlignment); } };
+		auto filled = std::pmr::vector<std::size_t>(radix, 0, source);
+
+		for (; first != last; ++first)
+		{
+			auto digit = static_cast<std::size_t>((radixKey(*first) >> shift) & digitMask);
+			auto block = blocks + digit * blockLength;
+			auto& count = filled[digit];
+
+			std::memcpy(static_cast<void*>(block + count), std::addressof(*first), sizeof(Item));
+
+			if (++count == blockLength)
+			{
+				std::memcpy(static_cast<void*>(destination + offsets[digit]), block, blockLength * sizeof(Item));
+				offsets[digit] += blockLength;
+				count = 0;
+			}
+		}
+
+		for (auto digit = std::size_t{ 0 }; digit < radix; ++digit)
+		{
+			std::memcpy(static_cast<void*>(destination + offsets[digit]), blocks + digit * blockLength, filled[digit] * sizeof(Item));
+			offsets[digit] += filled[digit];
+		}
+	}
+}
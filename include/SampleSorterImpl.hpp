@@ -0,0 +1,526 @@
+#pragma once
+
+#include <random>
+
+namespace IDragnev::Algorithm
+{
+	namespace Detail
+	{
+		//fixed size blocks of items moved out of a range,
+		//the items left in them are destroyed with it
+		template <typename Item>
+		class BlockBuffers
+		{
+		public:
+			BlockBuffers(std::size_t blocksCount, std::size_t blockLength);
+			BlockBuffers(BlockBuffers&& source) noexcept;
+			~BlockBuffers();
+
+			BlockBuffers(const BlockBuffers&) = delete;
+			BlockBuffers& operator=(const BlockBuffers&) = delete;
+			BlockBuffers& operator=(BlockBuffers&&) = delete;
+
+			//returns true if the block got full
+			bool push(std::size_t block, Item&& item);
+
+			template <typename InputIt>
+			void moveIn(std::size_t block, InputIt first);
+			template <typename OutputIt>
+			OutputIt moveOut(std::size_t block, OutputIt destination);
+			void clear(std::size_t block) noexcept;
+
+			Item* data(std::size_t block) noexcept { return items + block * blockLength; }
+			std::size_t size(std::size_t block) const noexcept { return sizes[block]; }
+
+		private:
+			std::vector<std::size_t> sizes;
+			std::size_t blockLength;
+			Item* items;
+		};
+
+		template <typename Item>
+		BlockBuffers<Item>::BlockBuffers(std::size_t blocksCount, std::size_t blockLength) :
+			sizes(blocksCount, 0),
+			blockLength(blockLength),
+			items(std::allocator<Item>{}.allocate(blocksCount * blockLength))
+		{
+		}
+
+		template <typename Item>
+		BlockBuffers<Item>::BlockBuffers(BlockBuffers&& source) noexcept :
+			sizes(std::move(source.sizes)),
+			blockLength(source.blockLength),
+			items(std::exchange(source.items, nullptr))
+		{
+		}
+
+		template <typename Item>
+		BlockBuffers<Item>::~BlockBuffers()
+		{
+			if (items != nullptr)
+			{
+				for (auto block = std::size_t{ 0 }; block < sizes.size(); ++block)
+				{
+					clear(block);
+				}
+
+				std::allocator<Item>{}.deallocate(items, sizes.size() * blockLength);
+			}
+		}
+
+		template <typename Item>
+		inline bool BlockBuffers<Item>::push(std::size_t block, Item&& item)
+		{
+			auto& size = sizes[block];
+			::new (static_cast<void*>(data(block) + size)) Item(std::move(item));
+
+			return ++size == blockLength;
+		}
+
+		//fills the block with the next blockLength items
+		template <typename Item>
+		template <typename InputIt>
+		void BlockBuffers<Item>::moveIn(std::size_t block, InputIt first)
+		{
+			std::uninitialized_move_n(first, blockLength, data(block));
+			sizes[block] = blockLength;
+		}
+
+		template <typename Item>
+		template <typename OutputIt>
+		OutputIt BlockBuffers<Item>::moveOut(std::size_t block, OutputIt destination)
+		{
+			auto items = data(block);
+			destination = std::move(items, items + sizes[block], destination);
+			clear(block);
+
+			return destination;
+		}
+
+		template <typename Item>
+		void BlockBuffers<Item>::clear(std::size_t block) noexcept
+		{
+			auto items = data(block);
+			std::destroy(items, items + sizes[block]);
+			sizes[block] = 0;
+		}
+
+		//an implicit binary search tree over sorted splitters, which routes each item
+		//with a comparison per level and no branches. Bucket 2b holds the items in
+		//(splitter[b - 1], splitter[b]) and bucket 2b + 1 the ones equal to splitter[b].
+		//Without repeated splitters the equal items stay in bucket 2b, saving a comparison
+		template <typename Item, typename CompareFn>
+		class SplitterTree
+		{
+		public:
+			//the count of the splitters must be one less than a power of two
+			SplitterTree(std::vector<Item> splitters, CompareFn lessThan);
+
+			std::size_t bucketsCount() const noexcept { return 2 * leavesCount; }
+
+			std::size_t operator()(const Item& item) const;
+
+			//the levels are walked for all items at once so that their comparisons overlap
+			template <typename RandomAccessIt>
+			void classify(RandomAccessIt first, std::size_t count, std::size_t* buckets) const;
+
+		private:
+			void build(std::size_t node, std::size_t low, std::size_t high);
+			std::size_t toBucket(std::size_t node, const Item& item) const;
+
+		private:
+			std::vector<Item> sorted;
+			std::vector<Item> tree;
+			std::size_t leavesCount;
+			std::size_t levelsCount = 0;
+			bool hasEqualBuckets = false;
+			CompareFn lessThan;
+		};
+
+		template <typename Item, typename CompareFn>
+		SplitterTree<Item, CompareFn>::SplitterTree(std::vector<Item> splitters, CompareFn lessThan) :
+			sorted(std::move(splitters)),
+			tree(sorted.size() + 1, sorted.front()),
+			leavesCount(sorted.size() + 1),
+			lessThan(lessThan)
+		{
+			while ((std::size_t{ 1 } << levelsCount) < leavesCount)
+			{
+				++levelsCount;
+			}
+
+			for (auto i = std::size_t{ 1 }; i < sorted.size(); ++i)
+			{
+				hasEqualBuckets |= !lessThan(sorted[i - 1], sorted[i]);
+			}
+
+			build(1, 0, sorted.size());
+
+			//the last bucket has no splitter above it, this one is only there to be compared with
+			sorted.push_back(sorted.back());
+		}
+
+		template <typename Item, typename CompareFn>
+		void SplitterTree<Item, CompareFn>::build(std::size_t node, std::size_t low, std::size_t high)
+		{
+			if (low < high)
+			{
+				auto middle = low + (high - low) / 2;
+				tree[node] = sorted[middle];
+
+				build(2 * node, low, middle);
+				build(2 * node + 1, middle + 1, high);
+			}
+		}
+
+		template <typename Item, typename CompareFn>
+		inline std::size_t SplitterTree<Item, CompareFn>::operator()(const Item& item) const
+		{
+			auto node = std::size_t{ 1 };
+			for (auto level = std::size_t{ 0 }; level < levelsCount; ++level)
+			{
+				node = 2 * node + static_cast<bool>(lessThan(tree[node], item));
+			}
+
+			return toBucket(node, item);
+		}
+
+		template <typename Item, typename CompareFn>
+		template <typename RandomAccessIt>
+		inline void SplitterTree<Item, CompareFn>::classify(RandomAccessIt first, std::size_t count, std::size_t* buckets) const
+		{
+			std::fill(buckets, buckets + count, std::size_t{ 1 });
+
+			for (auto level = std::size_t{ 0 }; level < levelsCount; ++level)
+			{
+				for (auto i = std::size_t{ 0 }; i < count; ++i)
+				{
+					buckets[i] = 2 * buckets[i] + static_cast<bool>(lessThan(tree[buckets[i]], first[i]));
+				}
+			}
+
+			for (auto i = std::size_t{ 0 }; i < count; ++i)
+			{
+				buckets[i] = toBucket(buckets[i], first[i]);
+			}
+		}
+
+		template <typename Item, typename CompareFn>
+		inline std::size_t SplitterTree<Item, CompareFn>::toBucket(std::size_t node, const Item& item) const
+		{
+			auto leaf = node - leavesCount;
+
+			if (hasEqualBuckets)
+			{
+				return 2 * leaf + ((leaf + 1 < leavesCount) & !lessThan(item, sorted[leaf]));
+			}
+			else
+			{
+				return 2 * leaf;
+			}
+		}
+	}
+
+	inline SampleSorter::SampleSorter(ThreadPool& pool, std::size_t threadsCount) noexcept :
+		pool(&pool),
+		threadsCount(threadsCount)
+	{
+	}
+
+	inline void SampleSorter::setThreadsCount(std::size_t count) noexcept
+	{
+		threadsCount = count;
+	}
+
+	inline std::size_t SampleSorter::getThreadsCount() const noexcept
+	{
+		return threadsCount;
+	}
+
+	inline ThreadPool& SampleSorter::threadPool() const
+	{
+		return (pool != nullptr) ? *pool : ThreadPool::shared();
+	}
+
+	inline std::size_t SampleSorter::threadsFor(std::ptrdiff_t length) const
+	{
+		auto threads = (threadsCount > 0) ? threadsCount : threadPool().workersCount() + 1;
+		return std::max(std::min(threads, static_cast<std::size_t>(length / minChunkLength)), std::size_t{ 1 });
+	}
+
+	template <typename RandomAccessIt, typename CompareFn>
+	inline void SampleSorter::operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) const
+	{
+		sort(first, last, lessThan);
+	}
+
+	template <typename RandomAccessIt, typename CompareFn>
+	void SampleSorter::sort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) const
+	{
+		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
+
+		const auto length = std::distance(first, last);
+		if (length <= baseCaseLength)
+		{
+			QuickSorter{}(first, last, lessThan);
+			return;
+		}
+		else if (std::is_sorted(first, last, lessThan))
+		{
+			return;
+		}
+
+		auto logLength = std::size_t{ 0 };
+		while ((std::ptrdiff_t{ 1 } << (logLength + 1)) <= length)
+		{
+			++logLength;
+		}
+
+		//buckets of a few hundred items on average are the smallest worth a pass
+		const auto logLeaves = std::min(maxLogBuckets, logLength - 8);
+		const auto leavesCount = std::size_t{ 1 } << logLeaves;
+		const auto oversampling = std::max(logLength / 5, std::size_t{ 1 });
+		const auto sampleLength = static_cast<std::ptrdiff_t>(oversampling * leavesCount - 1);
+
+		//the sample is moved to the front and sorted there, the seed keeps the sort repeatable
+		auto engine = std::minstd_rand{ static_cast<std::minstd_rand::result_type>(length) };
+		for (auto i = std::ptrdiff_t{ 0 }; i < sampleLength; ++i)
+		{
+			auto position = std::uniform_int_distribution<std::ptrdiff_t>{ i, length - 1 }(engine);
+			std::iter_swap(first + i, first + position);
+		}
+		QuickSorter{}(first, first + sampleLength, lessThan);
+
+		auto splitters = std::vector<Item>{};
+		splitters.reserve(leavesCount - 1);
+		for (auto leaf = std::size_t{ 1 }; leaf < leavesCount; ++leaf)
+		{
+			splitters.push_back(first[leaf * oversampling - 1]);
+		}
+
+		const auto classifier = Detail::SplitterTree<Item, CompareFn>{ std::move(splitters), lessThan };
+		const auto bounds = distribute(first, last, classifier);
+
+		//the items equal to a splitter are in place already
+		auto sortBucket = [this, first, lessThan, &bounds](std::size_t leaf)
+		{
+			sort(first + bounds[2 * leaf], first + bounds[2 * leaf + 1], lessThan);
+		};
+
+		if (threadsFor(length) > 1)
+		{
+			threadPool().forEachIndex(leavesCount, sortBucket);
+		}
+		else
+		{
+			for (auto leaf = std::size_t{ 0 }; leaf < leavesCount; ++leaf)
+			{
+				sortBucket(leaf);
+			}
+		}
+	}
+
+	//returns the bounds of the buckets, which the items are moved to in three steps:
+	//each thread moves the items of its stripe to per bucket buffers, writing the full
+	//blocks back to the front of the stripe. Then the full blocks are swapped into
+	//the block aligned slots of their buckets. At last the items which ended up past
+	//their bucket and the ones left in the buffers fill the gaps at the bucket ends
+	template <typename RandomAccessIt, typename Classifier>
+	std::vector<std::ptrdiff_t> SampleSorter::distribute(RandomAccessIt first, RandomAccessIt last, const Classifier& classifier) const
+	{
+		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
+		using Buffers = Detail::BlockBuffers<Item>;
+
+		constexpr auto batchLength = std::size_t{ 8 };
+
+		const auto length = std::distance(first, last);
+		const auto bucketsCount = classifier.bucketsCount();
+		const auto threads = threadsFor(length);
+
+		//the buffers of all threads take at most a quarter of the length
+		const auto maxBlockLength = std::max(blockBytes / sizeof(Item), std::size_t{ 1 });
+		const auto blockLength = static_cast<std::ptrdiff_t>(std::clamp(static_cast<std::size_t>(length) / (4 * bucketsCount * threads),
+																		std::size_t{ 1 }, maxBlockLength));
+		auto roundUp = [blockLength](std::ptrdiff_t position) { return (position + blockLength - 1) / blockLength * blockLength; };
+		auto slotOf = [blockLength](std::ptrdiff_t position) { return static_cast<std::size_t>(position / blockLength); };
+
+		const auto stripeLength = roundUp((length + static_cast<std::ptrdiff_t>(threads) - 1) / static_cast<std::ptrdiff_t>(threads));
+		auto buffers = std::vector<Buffers>{};
+		buffers.reserve(threads);
+		for (auto thread = std::size_t{ 0 }; thread < threads; ++thread)
+		{
+			buffers.emplace_back(bucketsCount, static_cast<std::size_t>(blockLength));
+		}
+
+		auto counts = std::vector<std::ptrdiff_t>(threads * bucketsCount, 0);
+		auto isFullBlock = std::vector<char>(slotOf(roundUp(length)), false);
+
+		auto classifyStripe = [&](std::size_t thread)
+		{
+			const auto begin = std::min(static_cast<std::ptrdiff_t>(thread) * stripeLength, length);
+			const auto end = std::min(begin + stripeLength, length);
+			auto& buffer = buffers[thread];
+			auto bucketCounts = counts.data() + thread * bucketsCount;
+			auto write = begin;
+			std::size_t buckets[batchLength];
+
+			for (auto read = begin; read < end; read += batchLength)
+			{
+				const auto count = std::min(static_cast<std::size_t>(end - read), batchLength);
+				classifier.classify(first + read, count, buckets);
+
+				for (auto i = std::size_t{ 0 }; i < count; ++i)
+				{
+					++bucketCounts[buckets[i]];
+
+					//the block is written over items which are all read already
+					if (buffer.push(buckets[i], std::move(first[read + i])))
+					{
+						buffer.moveOut(buckets[i], first + write);
+						isFullBlock[slotOf(write)] = true;
+						write += blockLength;
+					}
+				}
+			}
+		};
+
+		if (threads > 1)
+		{
+			threadPool().forEachIndex(threads, classifyStripe);
+		}
+		else
+		{
+			classifyStripe(0);
+		}
+
+		auto bucketLengths = std::vector<std::ptrdiff_t>(bucketsCount, 0);
+		for (auto thread = std::size_t{ 0 }; thread < threads; ++thread)
+		{
+			std::transform(std::begin(bucketLengths), std::end(bucketLengths), counts.data() + thread * bucketsCount, std::begin(bucketLengths), std::plus{});
+		}
+
+		auto bounds = std::vector<std::ptrdiff_t>(bucketsCount + 1);
+		exclusiveScan(std::begin(bucketLengths), std::end(bucketLengths), std::begin(bounds), std::ptrdiff_t{ 0 }, std::plus{});
+		bounds.back() = length;
+
+		//a block taken out goes to the next slot of its bucket, carrying on with
+		//the block which was there. The slot which ends past the range is kept aside
+		auto writes = std::vector<std::ptrdiff_t>(bucketsCount);
+		std::transform(std::begin(bounds), std::prev(std::end(bounds)), std::begin(writes), roundUp);
+
+		auto carried = Buffers{ 2, static_cast<std::size_t>(blockLength) };
+		auto overflow = Buffers{ 1, static_cast<std::size_t>(blockLength) };
+		auto overflowStart = length;
+
+		auto carry = [&](std::size_t held)
+		{
+			while (true)
+			{
+				const auto bucket = classifier(*carried.data(held));
+				auto& write = writes[bucket];
+
+				while (write + blockLength <= length && isFullBlock[slotOf(write)] && classifier(first[write]) == bucket)
+				{
+					isFullBlock[slotOf(write)] = false;
+					write += blockLength;
+				}
+
+				if (write + blockLength > length)
+				{
+					overflow.moveIn(0, carried.data(held));
+					carried.clear(held);
+					overflowStart = write;
+					write += blockLength;
+					return;
+				}
+				else if (!isFullBlock[slotOf(write)])
+				{
+					carried.moveOut(held, first + write);
+					write += blockLength;
+					return;
+				}
+				else
+				{
+					auto next = 1 - held;
+					carried.moveIn(next, first + write);
+					carried.moveOut(held, first + write);
+					isFullBlock[slotOf(write)] = false;
+					write += blockLength;
+					held = next;
+				}
+			}
+		};
+
+		const auto completeSlotsEnd = length / blockLength * blockLength;
+		for (auto bucket = std::size_t{ 0 }; bucket < bucketsCount; ++bucket)
+		{
+			const auto regionEnd = std::min(roundUp(bounds[bucket + 1]), completeSlotsEnd);
+
+			for (auto slot = roundUp(bounds[bucket]); slot < regionEnd; slot += blockLength)
+			{
+				if (!isFullBlock[slotOf(slot)])
+				{
+					continue;
+				}
+
+				isFullBlock[slotOf(slot)] = false;
+
+				if (slot == writes[bucket] && classifier(first[slot]) == bucket)
+				{
+					writes[bucket] += blockLength;
+				}
+				else
+				{
+					carried.moveIn(0, first + slot);
+					carry(0);
+				}
+			}
+		}
+
+		if (overflowStart < length)
+		{
+			std::move(overflow.data(0), overflow.data(0) + (length - overflowStart), first + overflowStart);
+		}
+
+		auto itemAt = [&](std::ptrdiff_t position) -> Item&
+		{
+			return (position < length) ? first[position] : overflow.data(0)[position - overflowStart];
+		};
+
+		//the buckets are fixed in order, so the gaps at the start of each are free
+		//by the time it comes, the last block of the bucket before is moved out of them
+		for (auto bucket = std::size_t{ 0 }; bucket < bucketsCount; ++bucket)
+		{
+			const auto begin = bounds[bucket];
+			const auto end = bounds[bucket + 1];
+			const auto blocksBegin = roundUp(begin);
+			const auto blocksEnd = writes[bucket];
+			const auto headEnd = std::min(blocksBegin, end);
+
+			auto gap = begin;
+			auto fillGap = [&](Item& item)
+			{
+				if (gap == headEnd)
+				{
+					gap = std::max(gap, blocksEnd);
+				}
+
+				first[gap++] = std::move(item);
+			};
+
+			for (auto position = std::max(end, blocksBegin); position < blocksEnd; ++position)
+			{
+				fillGap(itemAt(position));
+			}
+
+			for (auto& buffer : buffers)
+			{
+				auto items = buffer.data(bucket);
+				std::for_each(items, items + buffer.size(bucket), fillGap);
+				buffer.clear(bucket);
+			}
+		}
+
+		return bounds;
+	}
+}
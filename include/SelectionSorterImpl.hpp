@@ -27,6 +27,11 @@ namespace IDragnev::Algorithm
 	template <typename ForwardIt, typename CompareFn>
 	void SelectionSorter::operator()(ForwardIt first, ForwardIt last, CompareFn lessThan) const
 	{
+		if (first == last)
+		{
+			return;
+		}
+
 		auto end = std::next(first, std::distance(first, last) - 1);
 
 		for (auto current = first;
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <cmath>
+
+//__builtin_shufflevector came to GCC in version 12
+#if (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 12)) && (defined(__x86_64__) || defined(__i386__))
+#define IDRAGNEV_HAS_SIMD_NETWORK 1
+#define IDRAGNEV_ALWAYS_INLINE inline __attribute__((always_inline))
+#define IDRAGNEV_TARGET(isa) __attribute__((target(isa)))
+#else
+#define IDRAGNEV_HAS_SIMD_NETWORK 0
+#endif
+
+namespace IDragnev::Algorithm::Detail::SortingNetwork
+{
+	//keys of four or eight bytes are sorted in registers of 32 bytes
+	template <typename Key>
+	inline constexpr bool isSupportedKey = std::is_arithmetic_v<Key> &&
+										   !std::is_same_v<Key, bool> &&
+										   (sizeof(Key) == 4 || sizeof(Key) == 8);
+
+	inline constexpr std::size_t registerBytes = 32;
+	inline constexpr std::size_t maxRegisters = 8;
+
+	template <typename Key>
+	inline constexpr std::size_t maxLength = maxRegisters * registerBytes / sizeof(Key);
+
+#if IDRAGNEV_HAS_SIMD_NETWORK
+	enum class InstructionSet { none, sse42, avx2 };
+
+	inline InstructionSet detectInstructionSet() noexcept
+	{
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return InstructionSet::avx2;
+		}
+		else if (__builtin_cpu_supports("sse4.2"))
+		{
+			return InstructionSet::sse42;
+		}
+		else
+		{
+			return InstructionSet::none;
+		}
+	}
+
+	inline InstructionSet supportedInstructionSet() noexcept
+	{
+		static const auto set = detectInstructionSet();
+		return set;
+	}
+
+	//the network is written with generic vectors and always inlined, so
+	//each dispatch target below compiles it with its own instruction set
+	template <typename Key, bool descending>
+	struct Network
+	{
+		typedef Key Vector __attribute__((vector_size(registerBytes)));
+		static constexpr std::size_t lanes = registerBytes / sizeof(Key);
+
+		//both sides are picked by the same mask, so ties cannot duplicate a key
+		static IDRAGNEV_ALWAYS_INLINE void exchange(Vector& lower, Vector& upper) noexcept
+		{
+			auto swapped = descending ? (lower < upper) : (upper < lower);
+			auto first = swapped ? upper : lower;
+			auto second = swapped ? lower : upper;
+			lower = first;
+			upper = second;
+		}
+
+		//bitonic blocks alternate between the final order and its reverse
+		static constexpr bool isInOrderBlock(std::size_t item, std::size_t blockSize) noexcept
+		{
+			return (item & blockSize) == 0;
+		}
+
+		static constexpr bool keepsLater(std::size_t item, std::size_t blockSize, std::size_t distance) noexcept
+		{
+			return ((item & distance) != 0) == isInOrderBlock(item, blockSize);
+		}
+
+		template <std::size_t blockSize, std::size_t distance, std::size_t reg, std::size_t... lane>
+		static IDRAGNEV_ALWAYS_INLINE void exchangeLanes(Vector& v, std::index_sequence<lane...>) noexcept
+		{
+			Vector lower = v;
+			Vector upper = __builtin_shufflevector(v, v, (lane ^ distance)...);
+			exchange(lower, upper);
+
+			v = __builtin_shufflevector(lower, upper,
+				(keepsLater(reg * lanes + lane, blockSize, distance) ? lanes + lane : lane)...);
+		}
+
+		template <std::size_t blockSize, std::size_t distance, std::size_t... reg>
+		static IDRAGNEV_ALWAYS_INLINE void step(Vector* regs, std::index_sequence<reg...>) noexcept
+		{
+			if constexpr (distance >= lanes)
+			{
+				constexpr auto regsDistance = distance / lanes;
+
+				(((reg & regsDistance) == 0 ?
+					(isInOrderBlock(reg * lanes, blockSize) ? exchange(regs[reg], regs[reg | regsDistance])
+															  : exchange(regs[reg | regsDistance], regs[reg]))
+					: void()), ...);
+			}
+			else
+			{
+				(exchangeLanes<blockSize, distance, reg>(regs[reg], std::make_index_sequence<lanes>{}), ...);
+			}
+		}
+
+		template <std::size_t registers, std::size_t blockSize = 2, std::size_t distance = 1>
+		static IDRAGNEV_ALWAYS_INLINE void sortRegisters(Vector* regs) noexcept
+		{
+			if constexpr (blockSize <= registers * lanes)
+			{
+				step<blockSize, distance>(regs, std::make_index_sequence<registers>{});
+
+				if constexpr (distance > 1)
+				{
+					sortRegisters<registers, blockSize, distance / 2>(regs);
+				}
+				else
+				{
+					sortRegisters<registers, blockSize * 2, blockSize>(regs);
+				}
+			}
+		}
+
+		//the tail of the last register is padded with keys which sort after all others
+		template <std::size_t registers>
+		static IDRAGNEV_ALWAYS_INLINE void sortPadded(Key* first, std::size_t length) noexcept
+		{
+			constexpr auto padding = descending ? std::numeric_limits<Key>::lowest() : std::numeric_limits<Key>::max();
+			constexpr auto infinity = descending ? -std::numeric_limits<Key>::infinity() : std::numeric_limits<Key>::infinity();
+
+			Key keys[registers * lanes];
+			Vector regs[registers];
+
+			std::memcpy(keys, first, length * sizeof(Key));
+			std::fill(keys + length, keys + registers * lanes, std::numeric_limits<Key>::has_infinity ? infinity : padding);
+			std::memcpy(regs, keys, sizeof(regs));
+			sortRegisters<registers>(regs);
+			std::memcpy(keys, regs, sizeof(regs));
+			std::memcpy(first, keys, length * sizeof(Key));
+		}
+
+		static IDRAGNEV_ALWAYS_INLINE void sort(Key* first, std::size_t length) noexcept
+		{
+			if (length <= lanes)
+			{
+				sortPadded<1>(first, length);
+			}
+			else if (length <= 2 * lanes)
+			{
+				sortPadded<2>(first, length);
+			}
+			else if (length <= 4 * lanes)
+			{
+				sortPadded<4>(first, length);
+			}
+			else
+			{
+				sortPadded<8>(first, length);
+			}
+		}
+	};
+
+	template <typename Key>
+	IDRAGNEV_TARGET("avx2") void sortAvx2(Key* first, std::size_t length, bool descending) noexcept
+	{
+		descending ? Network<Key, true>::sort(first, length) : Network<Key, false>::sort(first, length);
+	}
+
+	template <typename Key>
+	IDRAGNEV_TARGET("sse4.2") void sortSse42(Key* first, std::size_t length, bool descending) noexcept
+	{
+		descending ? Network<Key, true>::sort(first, length) : Network<Key, false>::sort(first, length);
+	}
+#endif
+
+	inline bool isAvailable() noexcept
+	{
+#if IDRAGNEV_HAS_SIMD_NETWORK
+		return supportedInstructionSet() != InstructionSet::none;
+#else
+		return false;
+#endif
+	}
+
+	//returns false when the keys are left for another sort: too many of them,
+	//no SIMD on this CPU, NaNs which have no order or negative zeros. The network
+	//is not stable, which only shows on keys that are equal but not the same,
+	//and zeros of different sign are the only such keys besides NaNs
+	template <typename Key>
+	bool sort(Key* first, std::size_t length, bool descending) noexcept
+	{
+		static_assert(isSupportedKey<Key>);
+
+#if IDRAGNEV_HAS_SIMD_NETWORK
+		if (length < 2 || length > maxLength<Key>)
+		{
+			return false;
+		}
+
+		if constexpr (std::is_floating_point_v<Key>)
+		{
+			if (std::any_of(first, first + length, [](Key key) { return std::isnan(key) || (key == 0 && std::signbit(key)); }))
+			{
+				return false;
+			}
+		}
+
+		switch (supportedInstructionSet())
+		{
+		case InstructionSet::avx2:
+			sortAvx2(first, length, descending);
+			return true;
+		case InstructionSet::sse42:
+			sortSse42(first, length, descending);
+			return true;
+		default:
+			return false;
+		}
+#else
+		return false;
+#endif
+	}
+}
+
+#if IDRAGNEV_HAS_SIMD_NETWORK
+#undef IDRAGNEV_ALWAYS_INLINE
+#undef IDRAGNEV_TARGET
+#endif
+#undef IDRAGNEV_HAS_SIMD_NETWORK
@@ -0,0 +1,97 @@
+#pragma once
+
+namespace IDragnev::Algorithm
+{
+	//Batcher's odd-even merge sort with the comparators past the last item left out,
+	//it is optimal up to 8 items and a few comparators off beyond that
+	template <std::size_t N>
+	template <typename Callable>
+	constexpr void StaticSorter<N>::forEachComparator(Callable f)
+	{
+		for (auto p = std::size_t{ 1 }; p < N; p *= 2)
+		{
+			for (auto k = p; k >= 1; k /= 2)
+			{
+				for (auto j = k % p; j + k < N; j += 2 * k)
+				{
+					for (auto i = std::size_t{ 0 }; i < k && i + j + k < N; ++i)
+					{
+						if ((i + j) / (2 * p) == (i + j + k) / (2 * p))
+						{
+							f(i + j, i + j + k);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	template <std::size_t N>
+	constexpr std::size_t StaticSorter<N>::countComparators()
+	{
+		auto count = std::size_t{ 0 };
+		forEachComparator([&count](std::size_t, std::size_t) { ++count; });
+
+		return count;
+	}
+
+	template <std::size_t N>
+	constexpr auto StaticSorter<N>::makeNetwork()
+	{
+		auto network = std::array<Comparator, countComparators()>{};
+		auto count = std::size_t{ 0 };
+		forEachComparator([&network, &count](std::size_t lower, std::size_t upper) { network[count++] = { lower, upper }; });
+
+		return network;
+	}
+
+	template <std::size_t N>
+	template <typename RandomAccessIt, typename CompareFn>
+	inline constexpr void StaticSorter<N>::operator()(RandomAccessIt first, RandomAccessIt, CompareFn lessThan) const
+	{
+		apply(first, lessThan, std::make_index_sequence<comparatorsCount>{});
+	}
+
+	template <std::size_t N>
+	template <typename T, typename CompareFn>
+	inline constexpr void StaticSorter<N>::operator()(std::array<T, N>& items, CompareFn lessThan) const
+	{
+		(*this)(std::begin(items), std::end(items), lessThan);
+	}
+
+	template <std::size_t N>
+	template <typename RandomAccessIt, typename CompareFn, std::size_t... comparator>
+	constexpr void StaticSorter<N>::apply([[maybe_unused]] RandomAccessIt first, 
+										  [[maybe_unused]] CompareFn lessThan, 
+										  std::index_sequence<comparator...>)
+	{
+		[[maybe_unused]] constexpr auto network = makeNetwork();
+
+		(swapIfLess(first[network[comparator].upper], first[network[comparator].lower], lessThan), ...);
+	}
+
+	template <typename T, std::size_t N, typename CompareFn>
+	inline constexpr void staticSort(std::array<T, N>& items, CompareFn lessThan)
+	{
+		StaticSorter<N>{}(items, lessThan);
+	}
+
+	template <std::size_t maxLength>
+	template <typename RandomAccessIt, typename CompareFn>
+	void NetworkSorter<maxLength>::operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) const
+	{
+		auto count = static_cast<std::size_t>(std::distance(first, last));
+
+		if (!sortWithNetwork(first, count, lessThan, std::make_index_sequence<maxLength + 1>{}))
+		{
+			InsertionSorter{}(first, last, lessThan);
+		}
+	}
+
+	template <std::size_t maxLength>
+	template <typename RandomAccessIt, typename CompareFn, std::size_t... length>
+	bool NetworkSorter<maxLength>::sortWithNetwork(RandomAccessIt first, std::size_t count, CompareFn lessThan, std::index_sequence<length...>)
+	{
+		return ((count == length && (StaticSorter<length>{}(first, std::next(first, length), lessThan), true)) || ...);
+	}
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+namespace IDragnev::Algorithm
+{
+	template <typename RandomAccessIt, typename KeyFn>
+	void StringSorter::operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf) const
+	{
+		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
+		using Key = std::invoke_result_t<KeyFn&, const Item&>;
+
+		static_assert(std::is_convertible_v<Key, std::string_view>, "Keys must be convertible to std::string_view");
+		static_assert(std::is_reference_v<Key> || !std::is_same_v<std::decay_t<Key>, std::string>,
+					  "Keys are viewed while sorting and must not be returned as temporary strings");
+
+		const auto length = static_cast<std::size_t>(std::distance(first, last));
+		auto entries = std::vector<Entry>(length);
+		for (auto i = std::size_t{ 0 }; i < length; ++i)
+		{
+			entries[i] = { std::string_view{ keyOf(first[i]) }, i };
+		}
+
+		auto data = entries.data();
+		sortByAmericanFlag(data, data + length, 0);
+
+		//the items are read independently of each other when gathered in order,
+		//following the cycles of the permutation waits on each read before the next
+		auto sorted = std::vector<Item>{};
+		sorted.reserve(length);
+		for (const auto& entry : entries)
+		{
+			sorted.push_back(std::move(first[entry.index]));
+		}
+
+		std::move(std::begin(sorted), std::end(sorted), first);
+	}
+
+	inline void StringSorter::sortByAmericanFlag(Entry* first, Entry* last, std::size_t depth)
+	{
+		if (last - first <= americanFlagLength)
+		{
+			multikeyQuicksort(first, last, depth);
+			return;
+		}
+
+		const auto length = static_cast<std::size_t>(last - first);
+		auto characters = std::vector<std::uint16_t>(length);
+		auto counts = std::array<std::size_t, alphabetSize>{};
+
+		//a character shared by all keys only moves the comparison further
+		for (;; ++depth)
+		{
+			counts.fill(0);
+			for (auto i = std::size_t{ 0 }; i < length; ++i)
+			{
+				characters[i] = static_cast<std::uint16_t>(characterAt(first[i], depth));
+				++counts[characters[i]];
+			}
+
+			if (counts[characters[0]] < length)
+			{
+				break;
+			}
+			else if (characters[0] == 0)
+			{
+				return;
+			}
+		}
+
+		auto bucketStarts = std::array<std::size_t, alphabetSize>{};
+		auto bucketEnds = std::array<std::size_t, alphabetSize>{};
+		for (auto character = std::size_t{ 0 }, sum = std::size_t{ 0 }; character < alphabetSize; ++character)
+		{
+			bucketStarts[character] = sum;
+			sum += counts[character];
+			bucketEnds[character] = sum;
+		}
+
+		//every entry is swapped straight into the next free slot of its bucket
+		auto next = bucketStarts;
+		for (auto bucket = std::size_t{ 0 }; bucket < alphabetSize; ++bucket)
+		{
+			while (next[bucket] < bucketEnds[bucket])
+			{
+				auto position = next[bucket];
+				auto character = characters[position];
+
+				if (character == bucket)
+				{
+					++next[bucket];
+				}
+				else
+				{
+					auto target = next[character]++;
+					std::swap(first[position], first[target]);
+					std::swap(characters[position], characters[target]);
+				}
+			}
+		}
+
+		//the keys which ended are all equal
+		for (auto bucket = std::size_t{ 1 }; bucket < alphabetSize; ++bucket)
+		{
+			sortByAmericanFlag(first + bucketStarts[bucket], first + bucketEnds[bucket], depth + 1);
+		}
+	}
+
+	inline void StringSorter::multikeyQuicksort(Entry* first, Entry* last, std::size_t depth)
+	{
+		if (last - first <= insertionSortLength)
+		{
+			insertionSort(first, last, depth);
+			return;
+		}
+
+		//filled up to the length of the range, which the American flag sort keeps below americanFlagLength
+		std::array<std::uint16_t, americanFlagLength> characters;
+		const auto length = static_cast<std::size_t>(last - first);
+
+		for (auto i = std::size_t{ 0 }; i < length; ++i)
+		{
+			characters[i] = static_cast<std::uint16_t>(characterAt(first[i], depth));
+		}
+
+		multikeyQuicksort(first, last, characters.data(), depth);
+	}
+
+	inline void StringSorter::multikeyQuicksort(Entry* first, Entry* last, std::uint16_t* characters, std::size_t depth)
+	{
+		while (last - first > insertionSortLength)
+		{
+			const auto length = last - first;
+			auto a = characters[0];
+			auto b = characters[length / 2];
+			auto c = characters[length - 1];
+			auto pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+			//three way partition: [0, less) < pivot, [less, greater) == pivot, [greater, length) > pivot.
+			//The characters are moved along with their entries, so each key is read once per depth
+			auto less = std::ptrdiff_t{ 0 };
+			auto greater = length;
+			for (auto current = std::ptrdiff_t{ 0 }; current != greater; )
+			{
+				auto character = characters[current];
+
+				if (character < pivot)
+				{
+					std::swap(first[less], first[current]);
+					std::swap(characters[less++], characters[current++]);
+				}
+				else if (character > pivot)
+				{
+					--greater;
+					std::swap(first[current], first[greater]);
+					std::swap(characters[current], characters[greater]);
+				}
+				else
+				{
+					++current;
+				}
+			}
+
+			multikeyQuicksort(first, first + less, characters, depth);
+			multikeyQuicksort(first + greater, last, characters + greater, depth);
+
+			//the middle part goes on with the next character without recursing, shared prefixes can be long
+			if (pivot == 0)
+			{
+				return;
+			}
+
+			first += less;
+			last = first + (greater - less);
+			characters += less;
+			++depth;
+
+			for (auto i = std::ptrdiff_t{ 0 }; i < last - first; ++i)
+			{
+				characters[i] = static_cast<std::uint16_t>(characterAt(first[i], depth));
+			}
+		}
+
+		insertionSort(first, last, depth);
+	}
+
+	inline void StringSorter::insertionSort(Entry* first, Entry* last, std::size_t depth)
+	{
+		if (last - first < 2)
+		{
+			return;
+		}
+
+		//the first depth characters of the keys are known to be equal
+		InsertionSorter{}(first, last, [depth](const Entry& lhs, const Entry& rhs)
+		{
+			return lhs.key.substr(std::min(depth, lhs.key.size())) < rhs.key.substr(std::min(depth, rhs.key.size()));
+		});
+	}
+
+	inline std::size_t StringSorter::characterAt(const Entry& entry, std::size_t depth) noexcept
+	{
+		return (depth < entry.key.size()) ? static_cast<unsigned char>(entry.key[depth]) + std::size_t{ 1 } : 0;
+	}
+}
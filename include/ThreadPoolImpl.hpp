@@ -0,0 +1,231 @@
+#pragma once
+
+#include <chrono>
+
+namespace IDragnev::Algorithm
+{
+	inline ThreadPool::ThreadPool(std::size_t workersCount)
+	{
+		queues.reserve(workersCount + 1);
+		for (auto i = std::size_t{ 0 }; i <= workersCount; ++i)
+		{
+			queues.push_back(std::make_unique<WorkQueue>());
+		}
+
+		try
+		{
+			workers.reserve(workersCount);
+			for (auto i = std::size_t{ 0 }; i < workersCount; ++i)
+			{
+				workers.emplace_back([this, i]() { runWorker(i); });
+			}
+		}
+		catch (...)
+		{
+			stop();
+			throw;
+		}
+	}
+
+	inline ThreadPool::~ThreadPool()
+	{
+		stop();
+	}
+
+	inline void ThreadPool::stop() noexcept
+	{
+		{
+			auto lock = std::lock_guard{ sleepMutex };
+			isStopping = true;
+		}
+		wakeUp.notify_all();
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	inline std::size_t ThreadPool::workersCount() const noexcept
+	{
+		return workers.size();
+	}
+
+	inline std::size_t ThreadPool::defaultWorkersCount() noexcept
+	{
+		auto count = std::thread::hardware_concurrency();
+		return count > 0 ? count : 1;
+	}
+
+	inline ThreadPool& ThreadPool::shared()
+	{
+		static auto pool = ThreadPool{};
+		return pool;
+	}
+
+	template <typename Callable>
+	auto ThreadPool::submit(Callable f) -> std::future<std::invoke_result_t<Callable&>>
+	{
+		using Result = std::invoke_result_t<Callable&>;
+
+		auto task = std::make_shared<std::packaged_task<Result()>>(std::move(f));
+		auto result = task->get_future();
+		push([task]() { (*task)(); });
+
+		return result;
+	}
+
+	template <typename T>
+	void ThreadPool::wait(const std::future<T>& result)
+	{
+		auto isReady = [&result]()
+		{
+			return !result.valid() || result.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready;
+		};
+
+		while (!isReady())
+		{
+			if (!tryRunPendingTask())
+			{
+				//the awaited task runs on another thread, so this one sleeps
+				//until a task is done or there is a new one to help with
+				auto lock = std::unique_lock{ sleepMutex };
+				taskDone.wait(lock, [this, &isReady]() { return pendingTasksCount > 0 || isReady(); });
+			}
+		}
+	}
+
+	template <typename Callable>
+	void ThreadPool::forEachIndex(std::size_t count, Callable f)
+	{
+		auto results = std::vector<std::future<void>>{};
+		results.reserve(count);
+
+		auto x = CallOnDestruction{ [this, &results]() noexcept
+		{
+			for (auto& result : results)
+			{
+				wait(result);
+			}
+		} };
+
+		for (auto i = std::size_t{ 1 }; i < count; ++i)
+		{
+			results.push_back(submit([&f, i]() { f(i); }));
+		}
+
+		if (count > 0)
+		{
+			f(0);
+		}
+
+		for (auto& result : results)
+		{
+			wait(result);
+			result.get();
+		}
+	}
+
+	inline void ThreadPool::push(Task task)
+	{
+		auto& queue = *queues[ownQueueIndex()];
+
+		{
+			auto lock = std::lock_guard{ sleepMutex };
+			++pendingTasksCount;
+		}
+		{
+			auto lock = std::lock_guard{ queue.mutex };
+			queue.tasks.push_back(std::move(task));
+		}
+		wakeUp.notify_one();
+		taskDone.notify_all();
+	}
+
+	inline bool ThreadPool::tryRunPendingTask()
+	{
+		if (auto task = Task{};
+			tryPopOwn(task) || trySteal(task))
+		{
+			--pendingTasksCount;
+			task();
+
+			//a waiting thread checks its result under the lock,
+			//so taking it here makes sure the waiter sees the result
+			//or is already asleep when notified
+			{
+				auto lock = std::lock_guard{ sleepMutex };
+			}
+			taskDone.notify_all();
+
+			return true;
+		}
+
+		return false;
+	}
+
+	inline std::size_t ThreadPool::ownQueueIndex() const noexcept
+	{
+		//threads outside of the pool treat the shared queue as their own
+		return (currentPool == this) ? currentWorkerIndex : queues.size() - 1;
+	}
+
+	inline bool ThreadPool::tryPopOwn(Task& task)
+	{
+		auto& queue = *queues[ownQueueIndex()];
+		auto lock = std::lock_guard{ queue.mutex };
+
+		if (queue.tasks.empty())
+		{
+			return false;
+		}
+
+		task = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+
+		return true;
+	}
+
+	inline bool ThreadPool::trySteal(Task& task)
+	{
+		const auto count = queues.size();
+		const auto own = ownQueueIndex();
+
+		for (auto i = std::size_t{ 1 }; i < count; ++i)
+		{
+			auto& queue = *queues[(own + i) % count];
+			auto lock = std::lock_guard{ queue.mutex };
+
+			if (!queue.tasks.empty())
+			{
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	inline void ThreadPool::runWorker(std::size_t index)
+	{
+		currentPool = this;
+		currentWorkerIndex = index;
+
+		while (true)
+		{
+			if (tryRunPendingTask())
+			{
+				continue;
+			}
+
+			auto lock = std::unique_lock{ sleepMutex };
+			wakeUp.wait(lock, [this]() { return isStopping || pendingTasksCount > 0; });
+
+			if (isStopping && pendingTasksCount == 0)
+			{
+				return;
+			}
+		}
+	}
+}
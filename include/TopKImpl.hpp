@@ -0,0 +1,120 @@
+#pragma once
+
+namespace IDragnev::Algorithm
+{
+	template <typename T, std::size_t k, typename CompareFn>
+	TopK<T, k, CompareFn>::TopK(CompareFn lessThan) :
+		lessThan(lessThan)
+	{
+		items.reserve(2 * k);
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	void TopK<T, k, CompareFn>::push(const T& item)
+	{
+		if (isCandidate(item))
+		{
+			items.push_back(item);
+			compactIfFull();
+		}
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	void TopK<T, k, CompareFn>::push(T&& item)
+	{
+		if (isCandidate(item))
+		{
+			items.push_back(std::move(item));
+			compactIfFull();
+		}
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	template <typename InputIt>
+	void TopK<T, k, CompareFn>::push(InputIt first, InputIt last)
+	{
+		for (; first != last; ++first)
+		{
+			push(*first);
+		}
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	void TopK<T, k, CompareFn>::merge(const TopK& other)
+	{
+		push(std::cbegin(other.items), std::cend(other.items));
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	void TopK<T, k, CompareFn>::merge(TopK&& other)
+	{
+		push(std::make_move_iterator(std::begin(other.items)), std::make_move_iterator(std::end(other.items)));
+
+		other.items.clear();
+		other.hasThreshold = false;
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	inline std::vector<T> TopK<T, k, CompareFn>::sorted() const&
+	{
+		return sort(items, lessThan);
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	inline std::vector<T> TopK<T, k, CompareFn>::sorted() &&
+	{
+		hasThreshold = false;
+		return sort(std::move(items), lessThan);
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	inline std::size_t TopK<T, k, CompareFn>::size() const noexcept
+	{
+		return std::min(items.size(), k);
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	inline bool TopK<T, k, CompareFn>::isEmpty() const noexcept
+	{
+		return items.empty();
+	}
+
+	//the threshold is the k-th greatest item at the last compaction
+	template <typename T, std::size_t k, typename CompareFn>
+	inline bool TopK<T, k, CompareFn>::isCandidate(const T& item) const
+	{
+		return !hasThreshold || lessThan(items[k - 1], item);
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	inline void TopK<T, k, CompareFn>::compactIfFull()
+	{
+		if (items.size() == 2 * k)
+		{
+			compact();
+		}
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	void TopK<T, k, CompareFn>::compact()
+	{
+		auto greaterThan = [this](const T& lhs, const T& rhs) { return lessThan(rhs, lhs); };
+
+		auto kth = std::begin(items) + (k - 1);
+		nthElement(std::begin(items), kth, std::end(items), greaterThan);
+		items.erase(std::next(kth), std::end(items));
+		hasThreshold = true;
+	}
+
+	template <typename T, std::size_t k, typename CompareFn>
+	std::vector<T> TopK<T, k, CompareFn>::sort(std::vector<T> items, CompareFn lessThan)
+	{
+		auto greaterThan = [lessThan](const T& lhs, const T& rhs) { return lessThan(rhs, lhs); };
+		auto count = std::min(items.size(), k);
+
+		partialSort(std::begin(items), std::begin(items) + count, std::end(items), greaterThan);
+		items.erase(std::begin(items) + count, std::end(items));
+
+		return items;
+	}
+}
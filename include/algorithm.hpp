@@ -3,6 +3,26 @@
 #include "functional.hpp"
 #include <future>
 #include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <memory_resource>
+#include <limits>
+#include <filesystem>
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
 
 namespace IDragnev::Algorithm
 {
@@ -28,16 +48,39 @@ namespace IDragnev::Algorithm
 	};
 
 	template <typename T, typename CompareFn>
-	void swapIfLess(T& lhs, T& rhs, CompareFn lessThan)
+	constexpr void swapIfLess(T& lhs, T& rhs, CompareFn lessThan)
 	{
-		using std::swap;
-
 		if (lessThan(lhs, rhs))
 		{
-			swap(lhs, rhs);
+			//std::swap is not constexpr yet
+			if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				auto temp = lhs;
+				lhs = rhs;
+				rhs = temp;
+			}
+			else
+			{
+				using std::swap;
+				swap(lhs, rhs);
+			}
 		}
 	}
 
+	template <typename Iterator, typename Item = typename std::iterator_traits<Iterator>::value_type>
+	inline constexpr bool isContiguousIterator = std::is_pointer_v<Iterator> ||
+		(!std::is_same_v<Item, bool> && std::is_same_v<Iterator, typename std::vector<Item>::iterator>);
+
+	namespace Detail
+	{
+		//orderings of arithmetic items which can be compared without branches
+		template <typename Item, typename CompareFn>
+		inline constexpr bool isPlainOrdering = std::is_same_v<CompareFn, std::less<>> ||
+												std::is_same_v<CompareFn, std::less<Item>> ||
+												std::is_same_v<CompareFn, std::greater<>> ||
+												std::is_same_v<CompareFn, std::greater<Item>>;
+	}
+
 	class InsertionSorter
 	{
 	public:
@@ -62,16 +105,556 @@ namespace IDragnev::Algorithm
 		void operator()(ForwardIt first, ForwardIt last, CompareFn lessThan = {}) const;
 	};
 
-	template <typename RandomAccessIt, std::size_t lowerBound = 25>
+	//an unstable in-place sort after pattern-defeating quicksort: ninther pivots, 
+	//partitions which compare arithmetic keys in blocks without branching, 
+	//a quick finish for inputs which turn out already partitioned and 
+	//heapsort once too many partitions come out unbalanced
+	class QuickSorter
+	{
+	private:
+		static constexpr std::ptrdiff_t insertionSortLength = 24;
+		static constexpr std::ptrdiff_t nintherLength = 128;
+
+		//a partition which needed no swaps gives up on insertion sort after that many moves
+		static constexpr std::ptrdiff_t partialInsertionSortLimit = 8;
+
+		static constexpr std::ptrdiff_t blockLength = 64;
+
+	public:
+		template <typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+		void operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {}) const;
+
+	private:
+		template <bool branchless, typename RandomAccessIt, typename CompareFn>
+		static void sortLoop(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan, int badPartitionsAllowed, bool isLeftmost);
+
+		template <typename RandomAccessIt, typename CompareFn>
+		static auto partitionRight(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) -> std::pair<RandomAccessIt, bool>;
+		template <typename RandomAccessIt, typename CompareFn>
+		static auto partitionRightBranchless(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) -> std::pair<RandomAccessIt, bool>;
+		template <typename RandomAccessIt, typename CompareFn>
+		static RandomAccessIt partitionLeft(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan);
+		template <typename RandomAccessIt>
+		static void swapOffsets(RandomAccessIt first, RandomAccessIt last, const unsigned char* leftOffsets, const unsigned char* rightOffsets, std::size_t count, bool useSwaps);
+
+		template <typename RandomAccessIt, typename CompareFn>
+		static bool partialInsertionSort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan);
+		template <typename RandomAccessIt, typename CompareFn>
+		static void sort3(RandomAccessIt a, RandomAccessIt b, RandomAccessIt c, CompareFn lessThan);
+		template <typename RandomAccessIt, typename CompareFn>
+		static void sort2(RandomAccessIt a, RandomAccessIt b, CompareFn lessThan);
+	};
+
+	//heaps with the greatest item at the front and the children of item i at 
+	//arity * i + 1, ..., arity * i + arity. Wider heaps are shallower and keep 
+	//siblings next to each other, trading comparisons for fewer cache misses
+	template <std::size_t arity = 2, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	void makeHeap(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {});
+
+	//adds the item at last - 1 to the heap [first, last - 1)
+	template <std::size_t arity = 2, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	void pushHeap(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {});
+
+	//moves the greatest item to last - 1 and makes [first, last - 1) a heap
+	template <std::size_t arity = 2, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	void popHeap(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {});
+
+	template <std::size_t arity = 2, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	void heapSort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {});
+
+	//rearranges the range so that nth holds the item which would be there if the range
+	//was sorted and no item after it is less than one before it. It is an introselect:
+	//quickselect with Floyd-Rivest sampling of the pivot in long ranges, which falls
+	//back to median of medians when partitions keep coming out unbalanced, O(n) at worst
+	template <typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	void nthElement(RandomAccessIt first, RandomAccessIt nth, RandomAccessIt last, CompareFn lessThan = {});
+
+	//sorts the smallest middle - first items into [first, middle), 
+	//the rest are left in unspecified order
+	template <typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	void partialSort(RandomAccessIt first, RandomAccessIt middle, RandomAccessIt last, CompareFn lessThan = {});
+
+	//copies as many of the smallest items as fit to the destination, sorted,
+	//and returns the end of the copied ones
+	template <typename InputIt, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	RandomAccessIt partialSortCopy(InputIt first, InputIt last, RandomAccessIt destFirst, RandomAccessIt destLast, CompareFn lessThan = {});
+
+	//accumulates the k greatest of the items pushed to it, as ordered by lessThan, 
+	//in a buffer of 2k items. Once the buffer fills up nthElement keeps the k greatest 
+	//and the least of them becomes the threshold which the next items are compared with
+	template <typename T, std::size_t k, typename CompareFn = decltype(std::less{})>
+	class TopK
+	{
+	private:
+		static_assert(k > 0, "TopK must keep at least one item");
+
+	public:
+		explicit TopK(CompareFn lessThan = {});
+
+		void push(const T& item);
+		void push(T&& item);
+
+		template <typename InputIt>
+		void push(InputIt first, InputIt last);
+
+		//keeps the k greatest of the items in both
+		void merge(const TopK& other);
+		void merge(TopK&& other);
+
+		//the kept items from the greatest to the least
+		std::vector<T> sorted() const&;
+		std::vector<T> sorted() &&;
+
+		std::size_t size() const noexcept;
+		bool isEmpty() const noexcept;
+
+	private:
+		bool isCandidate(const T& item) const;
+		void compactIfFull();
+		void compact();
+		static std::vector<T> sort(std::vector<T> items, CompareFn lessThan);
+
+	private:
+		std::vector<T> items;
+		bool hasThreshold = false;
+		CompareFn lessThan;
+	};
+
+	//a priority queue over a heap of the given arity with the greatest item on top.
+	//The storage is aligned so that the children of each item start at a cache line,
+	//with 4 or 8 children of up to 16 or 8 bytes they share a single line
+	template <typename T, std::size_t arity = 4, typename CompareFn = decltype(std::less{})>
+	class DaryHeap
+	{
+	private:
+		static_assert(arity >= 2, "Heaps must have at least two children per item");
+		static_assert(std::is_nothrow_move_constructible_v<T>, "Items are moved when the storage grows");
+
+		static constexpr std::size_t cacheLineBytes = 64;
+		static constexpr std::size_t alignment = std::max(cacheLineBytes, alignof(T));
+
+		//the children of item i are at arity * (i + 1) in the storage
+		static constexpr std::size_t padding = arity - 1;
+		static constexpr std::size_t maxCapacity = std::numeric_limits<std::size_t>::max() / sizeof(T) - padding;
+
+	public:
+		explicit DaryHeap(CompareFn lessThan = {}, std::pmr::memory_resource* resource = nullptr);
+		template <typename InputIt>
+		DaryHeap(InputIt first, InputIt last, CompareFn lessThan = {}, std::pmr::memory_resource* resource = nullptr);
+		DaryHeap(const DaryHeap& source);
+		DaryHeap(DaryHeap&& source) noexcept;
+		~DaryHeap();
+
+		DaryHeap& operator=(const DaryHeap& rhs);
+		DaryHeap& operator=(DaryHeap&& rhs) noexcept;
+
+		void push(const T& item);
+		void push(T&& item);
+		template <typename... Args>
+		void emplace(Args&&... args);
+
+		//a batch about as big as the heap is added by rebuilding it in linear time
+		template <typename InputIt>
+		void pushBatch(InputIt first, InputIt last);
+
+		const T& top() const noexcept;
+		T pop();
+
+		//pops up to count items from the greatest down and returns the end of the written ones
+		template <typename OutputIt>
+		OutputIt popBatch(std::size_t count, OutputIt destination);
+
+		void reserve(std::size_t capacity);
+		void clear() noexcept;
+
+		std::size_t size() const noexcept;
+		bool isEmpty() const noexcept;
+
+	private:
+		void growFor(std::size_t count);
+		void reallocate(std::size_t capacity);
+		void release() noexcept;
+		T* data() const noexcept;
+
+	private:
+		std::byte* storage = nullptr;
+		std::size_t count = 0;
+		std::size_t capacity = 0;
+		std::pmr::memory_resource* resource;
+		//lambdas cannot be assigned, so the comparator is emplaced instead
+		std::optional<CompareFn> lessThan;
+	};
+
+	//a fixed network of swapIfLess calls sorting exactly N items,
+	//it is unstable and can be evaluated in constant expressions
+	template <std::size_t N>
+	class StaticSorter
+	{
+	private:
+		struct Comparator
+		{
+			std::size_t lower = 0;
+			std::size_t upper = 0;
+		};
+
+		template <typename Callable>
+		static constexpr void forEachComparator(Callable f);
+		static constexpr std::size_t countComparators();
+		static constexpr auto makeNetwork();
+
+	public:
+		static constexpr std::size_t comparatorsCount = countComparators();
+
+		template <typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+		constexpr void operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {}) const;
+
+		template <typename T, typename CompareFn = decltype(std::less{})>
+		constexpr void operator()(std::array<T, N>& items, CompareFn lessThan = {}) const;
+
+	private:
+		template <typename RandomAccessIt, typename CompareFn, std::size_t... comparator>
+		static constexpr void apply(RandomAccessIt first, CompareFn lessThan, std::index_sequence<comparator...>);
+	};
+
+	template <typename T, std::size_t N, typename CompareFn = decltype(std::less{})>
+	constexpr void staticSort(std::array<T, N>& items, CompareFn lessThan = {});
+
+	//picks the StaticSorter of the range's length and falls back to
+	//insertion sort past maxLength, it is unstable like the networks
+	template <std::size_t maxLength = 16>
+	class NetworkSorter
+	{
+	public:
+		template <typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+		void operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {}) const;
+
+	private:
+		template <typename RandomAccessIt, typename CompareFn, std::size_t... length>
+		static bool sortWithNetwork(RandomAccessIt first, std::size_t count, CompareFn lessThan, std::index_sequence<length...>);
+	};
+
+	struct Identity
+	{
+		template <typename T>
+		constexpr const T& operator()(const T& item) const noexcept { return item; }
+	};
+
+	class ThreadPool;
+
+	//a stable LSD radix sort by an arithmetic key taken from each item.
+	//Signed and floating point keys are mapped to unsigned ones keeping
+	//their order, -0.0 goes before 0.0 and NaNs go to the ends by sign
+	template <std::size_t digitBits = 8>
+	class RadixSorter
+	{
+	private:
+		static_assert(digitBits > 0 && digitBits <= 16, "Digits must have between 1 and 16 bits");
+
+		static constexpr std::size_t radix = std::size_t{ 1 } << digitBits;
+
+		//shorter ranges do not pay off the counting
+		static constexpr std::ptrdiff_t insertionSortLength = 64;
+
+		//shorter chunks do not pay off a thread
+		static constexpr std::size_t minChunkLength = 1 << 16;
+
+		//items are gathered by digit in blocks of a cache line before being written out
+		static constexpr std::size_t cacheLineBytes = 64;
+
+	public:
+		RadixSorter() = default;
+
+		//sorts with threadsCount threads, the calling one and the rest from the pool.
+		//Zero stands for all workers of the pool and the calling thread
+		explicit RadixSorter(ThreadPool& pool, std::size_t threadsCount = 0) noexcept;
+
+		template <typename RandomAccessIt, typename KeyFn = Identity>
+		void operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf = {}) const;
+
+		//scratch memory is taken from the resource, nullptr stands for the default one
+		void setMemoryResource(std::pmr::memory_resource* resource) noexcept;
+		std::pmr::memory_resource* getMemoryResource() const noexcept;
+
+		void setThreadsCount(std::size_t count) noexcept;
+		std::size_t getThreadsCount() const noexcept;
+
+	private:
+		template <typename RandomAccessIt, typename RadixKeyFn>
+		void sort(RandomAccessIt first, RandomAccessIt last, RadixKeyFn radixKey) const;
+		template <typename RandomAccessIt, typename RadixKeyFn>
+		void countDigits(RandomAccessIt first, RandomAccessIt last, std::size_t* counts, RadixKeyFn radixKey) const;
+		template <typename SourceIt, typename DestIt, typename RadixKeyFn>
+		void distributeInParallel(SourceIt first, SourceIt last, DestIt destination, std::size_t threads, unsigned shift, bool construct, RadixKeyFn radixKey) const;
+		template <typename SourceIt, typename DestIt, typename RadixKeyFn>
+		static void scatter(SourceIt first, SourceIt last, DestIt destination, std::size_t* offsets, unsigned shift, bool construct, RadixKeyFn radixKey);
+		template <typename SourceIt, typename Item, typename RadixKeyFn>
+		void scatterCombined(SourceIt first, SourceIt last, Item* destination, std::size_t* offsets, unsigned shift, RadixKeyFn radixKey) const;
+		std::size_t threadsFor(std::size_t length) const;
+		ThreadPool& threadPool() const;
+
+	private:
+		std::pmr::memory_resource* resource = nullptr;
+		ThreadPool* pool = nullptr;
+		std::size_t threadsCount = 1;
+	};
+
+	//a stable counting sort by an integral or enumeration key taken from each item.
+	//The items of every key are counted and each item is moved straight to its place,
+	//so it suits keys from a small range like ids or status codes. Ranges for which
+	//isSuitable tells counting does not pay off are left to RadixSorter
+	class CountingSorter
+	{
+	private:
+		//more counts than that do not fit the cache along with the items
+		static constexpr std::size_t maxKeysCount = std::size_t{ 1 } << 16;
+
+		//bigger items are ordered through a permutation of their indices and
+		//moved once in place, instead of twice through a buffer of their size
+		static constexpr std::size_t recordBytes = 64;
+
+		//shorter chunks do not pay off a thread
+		static constexpr std::size_t minChunkLength = 1 << 16;
+
+	public:
+		CountingSorter() = default;
+
+		//sorts with threadsCount threads, the calling one and the rest from the pool.
+		//Zero stands for all workers of the pool and the calling thread
+		explicit CountingSorter(ThreadPool& pool, std::size_t threadsCount = 0) noexcept;
+
+		//the range of the keys is found in a pass over them
+		template <typename RandomAccessIt, typename KeyFn = Identity>
+		void operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf = {}) const;
+
+		//all keys must be in [minKey, maxKey], a key out of it
+		//throws std::out_of_range before any item is moved
+		template <typename RandomAccessIt, typename KeyFn, typename Key>
+		void operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf, Key minKey, Key maxKey) const;
+
+		//whether counting pays off for that many items with keys in [minKey, maxKey]
+		template <typename Key>
+		static bool isSuitable(std::size_t length, Key minKey, Key maxKey) noexcept;
+
+		//scratch memory is taken from the resource, nullptr stands for the default one
+		void setMemoryResource(std::pmr::memory_resource* resource) noexcept;
+		std::pmr::memory_resource* getMemoryResource() const noexcept;
+
+		void setThreadsCount(std::size_t count) noexcept;
+		std::size_t getThreadsCount() const noexcept;
+
+	private:
+		template <typename RandomAccessIt, typename KeyFn, typename CountingKey>
+		void sortInRange(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf, CountingKey minKey, CountingKey maxKey) const;
+		template <typename RandomAccessIt, typename KeyFn, typename CountingKey>
+		void checkKeys(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf, CountingKey minKey, CountingKey maxKey) const;
+		template <typename RandomAccessIt, typename IndexFn>
+		void sort(RandomAccessIt first, RandomAccessIt last, IndexFn indexOf, std::size_t keysCount) const;
+		template <typename RandomAccessIt, typename IndexFn>
+		void moveThroughBuffer(RandomAccessIt first, std::size_t size, std::size_t threads, std::size_t* offsets, std::size_t keysCount, IndexFn indexOf) const;
+		template <typename Index, typename RandomAccessIt, typename IndexFn>
+		void moveByPermutation(RandomAccessIt first, std::size_t size, std::size_t threads, std::size_t* offsets, std::size_t keysCount, IndexFn indexOf) const;
+		template <typename Callable>
+		void forEachChunk(std::size_t threads, Callable f) const;
+		template <typename RandomAccessIt, typename KeyFn>
+		void sortByRadix(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf) const;
+		std::size_t threadsFor(std::size_t length) const;
+		ThreadPool& threadPool() const;
+
+	private:
+		std::pmr::memory_resource* resource = nullptr;
+		ThreadPool* pool = nullptr;
+		std::size_t threadsCount = 1;
+	};
+
+	//sorts by a string key taken from each item, one character at a time: 
+	//American flag distribution for big buckets, multikey quicksort for medium 
+	//ones and insertion sort past the known common prefix for small ones. 
+	//Characters compare as unsigned like in std::string, the sort is unstable
+	class StringSorter
+	{
+	private:
+		//the keys are sorted as views and the items are gathered in order at the end
+		struct Entry
+		{
+			std::string_view key;
+			std::size_t index = 0;
+		};
+
+		static constexpr std::ptrdiff_t insertionSortLength = 16;
+		static constexpr std::ptrdiff_t americanFlagLength = 4'096;
+
+		//a character past the end of the key goes before all others
+		static constexpr std::size_t alphabetSize = 257;
+
+	public:
+		template <typename RandomAccessIt, typename KeyFn = Identity>
+		void operator()(RandomAccessIt first, RandomAccessIt last, KeyFn keyOf = {}) const;
+
+	private:
+		static void sortByAmericanFlag(Entry* first, Entry* last, std::size_t depth);
+		static void multikeyQuicksort(Entry* first, Entry* last, std::size_t depth);
+		static void multikeyQuicksort(Entry* first, Entry* last, std::uint16_t* characters, std::size_t depth);
+		static void insertionSort(Entry* first, Entry* last, std::size_t depth);
+		static std::size_t characterAt(const Entry& entry, std::size_t depth) noexcept;
+	};
+
+	//an unstable parallel samplesort after IPS4o: splitters are taken from a sorted 
+	//random sample, items are classified through a splitter tree without branching, 
+	//moved to their buckets by whole blocks within the range and the buckets are 
+	//sorted in parallel. Besides the blocks buffered by each thread no memory is taken.
+	//Splitters are copies of items, so the items must be copy constructible
+	class SampleSorter
+	{
+	private:
+		//shorter ranges are left to QuickSorter
+		static constexpr std::ptrdiff_t baseCaseLength = 4'096;
+
+		static constexpr std::size_t maxLogBuckets = 8;
+		static constexpr std::size_t blockBytes = 2'048;
+
+		//shorter chunks do not pay off a thread
+		static constexpr std::ptrdiff_t minChunkLength = 1 << 16;
+
+	public:
+		SampleSorter() = default;
+
+		//sorts with threadsCount threads, the calling one and the rest from the pool.
+		//Zero stands for all workers of the pool and the calling thread
+		explicit SampleSorter(ThreadPool& pool, std::size_t threadsCount = 0) noexcept;
+
+		template <typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+		void operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {}) const;
+
+		void setThreadsCount(std::size_t count) noexcept;
+		std::size_t getThreadsCount() const noexcept;
+
+	private:
+		template <typename RandomAccessIt, typename CompareFn>
+		void sort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) const;
+		template <typename RandomAccessIt, typename Classifier>
+		std::vector<std::ptrdiff_t> distribute(RandomAccessIt first, RandomAccessIt last, const Classifier& classifier) const;
+		std::size_t threadsFor(std::ptrdiff_t length) const;
+		ThreadPool& threadPool() const;
+
+	private:
+		ThreadPool* pool = nullptr;
+		std::size_t threadsCount = 0;
+	};
+
+	class ThreadPool
+	{
+	private:
+		using Task = std::function<void()>;
+
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+	public:
+		explicit ThreadPool(std::size_t workersCount = defaultWorkersCount());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		template <typename Callable>
+		auto submit(Callable f) -> std::future<std::invoke_result_t<Callable&>>;
+
+		//runs pending tasks on the calling thread until result is ready
+		//and sleeps while there are none
+		template <typename T>
+		void wait(const std::future<T>& result);
+
+		//calls f(0), ..., f(count - 1) in parallel, f(0) on the calling thread,
+		//and returns when all of them have, rethrowing the first exception
+		template <typename Callable>
+		void forEachIndex(std::size_t count, Callable f);
+
+		std::size_t workersCount() const noexcept;
+
+		static ThreadPool& shared();
+		static std::size_t defaultWorkersCount() noexcept;
+
+	private:
+		void push(Task task);
+		bool tryRunPendingTask();
+		bool tryPopOwn(Task& task);
+		std::size_t ownQueueIndex() const noexcept;
+		bool trySteal(Task& task);
+		void runWorker(std::size_t index);
+		void stop() noexcept;
+
+	private:
+		std::vector<std::unique_ptr<WorkQueue>> queues;
+		std::vector<std::thread> workers;
+		std::atomic<std::size_t> pendingTasksCount = 0;
+		std::mutex sleepMutex;
+		std::condition_variable wakeUp;
+		std::condition_variable taskDone;
+		bool isStopping = false;
+
+		inline static thread_local ThreadPool* currentPool = nullptr;
+		inline static thread_local std::size_t currentWorkerIndex = 0;
+	};
+
+	enum class MergeStrategy
+	{
+		balanced,
+		natural
+	};
+
+	struct MergeStatistics
+	{
+		std::size_t merges = 0;
+		std::size_t skippedMerges = 0;
+		std::size_t rotations = 0;
+	};
+
+	//the run time settings of a MergeSorter which are worth measuring
+	struct MergeSorterTuning
+	{
+		std::size_t leafLength = 25;
+		std::size_t parallelGrain = 0;
+		MergeStrategy strategy = MergeStrategy::balanced;
+	};
+
+	//parallelGrain is the length up to which ranges are sorted
+	//on the calling thread, 0 picks it from the length of the range
+	//
+	//the natural strategy merges the runs already present in the range
+	//and runs sequentially, shorter runs are extended to lowerBound items
+	//
+	//LeafSorter sorts the ranges of up to lowerBound items (or the 
+	//leaf length set at run time), the sort is only stable if it is
+	template <typename RandomAccessIt, std::size_t lowerBound = 25, std::size_t parallelGrain = 0, typename LeafSorter = InsertionSorter>
 	class MergeSorter
 	{
 	private:
 		using Item = typename std::iterator_traits<RandomAccessIt>::value_type;
 		using Difference = typename std::iterator_traits<RandomAccessIt>::difference_type;
-		using Buffer = std::vector<Item>;
+
+		struct BufferDeleter
+		{
+			std::pmr::memory_resource* resource = nullptr;
+			std::size_t size = 0;
+			void operator()(Item* items) const noexcept { resource->deallocate(items, size * sizeof(Item), alignof(Item)); }
+		};
+
+		//uninitialized storage, items are constructed in it only if they are not trivially copyable
+		using Buffer = std::unique_ptr<Item, BufferDeleter>;
+
+		template <typename InputIt, typename OutputIt, typename CompareFn>
+		static constexpr bool hasBranchlessMerge = std::is_arithmetic_v<Item> && 
+												   std::is_pointer_v<InputIt> && 
+												   std::is_pointer_v<OutputIt> &&
+												   Detail::isPlainOrdering<Item, CompareFn>;
 
 	public:
 		MergeSorter() = default;
+		explicit MergeSorter(ThreadPool& pool) noexcept;
+		MergeSorter(ThreadPool& pool, std::size_t grain) noexcept;
 		MergeSorter(const MergeSorter& source) noexcept;
 		~MergeSorter() = default;
 
@@ -80,30 +663,265 @@ namespace IDragnev::Algorithm
 		template <typename CompareFn = decltype(std::less{})>
 		void operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {});
 
+		void setParallelGrain(std::size_t grain) noexcept;
+		std::size_t getParallelGrain() const noexcept;
+
+		void setStrategy(MergeStrategy strategy) noexcept;
+		MergeStrategy getStrategy() const noexcept;
+
+		//counts of the merges done in full, skipped since the halves 
+		//were already in order and replaced by a rotation of the halves
+		MergeStatistics getStatistics() const noexcept;
+		void resetStatistics() noexcept;
+
+		//scratch memory is taken from the resource, nullptr stands for the default one
+		void setMemoryResource(std::pmr::memory_resource* resource) noexcept;
+		std::pmr::memory_resource* getMemoryResource() const noexcept;
+
+		//the most items the scratch buffer may hold, down to zero. Merges which 
+		//do not fit are split by rotations until they do, which keeps the sort stable
+		void setScratchLimit(std::size_t items) noexcept;
+		std::size_t getScratchLimit() const noexcept;
+
+		//overrides lowerBound, at least one item
+		void setLeafLength(std::size_t items) noexcept;
+		std::size_t getLeafLength() const noexcept;
+
+		void setTuning(const MergeSorterTuning& tuning) noexcept;
+		MergeSorterTuning getTuning() const noexcept;
+
 	private:
+		struct Run
+		{
+			Difference start = 0;
+			Difference length = 0;
+		};
+
+		struct Scratch
+		{
+			Item* items = nullptr;
+			Difference size = 0;
+		};
+
+		static constexpr Difference minGallop = 7;
+
+		template <typename Iterator, typename CompareFn>
+		void sortNaturally(Iterator first, Iterator last, Scratch scratch, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		static Difference nextRunLength(Iterator first, Iterator last, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		void collapseRuns(std::pmr::vector<Run>& runs, Iterator first, Scratch scratch, bool force, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		void mergeRuns(Iterator first, Iterator middle, Iterator last, Scratch scratch, CompareFn lessThan);
+		template <typename Iterator>
+		static void rotateRuns(Iterator first, Iterator middle, Iterator last, Scratch scratch);
+		template <typename Iterator, typename CompareFn>
+		void sortInPlace(Iterator first, Iterator last, Scratch scratch, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		static void mergeAdaptive(Iterator first, Iterator middle, Iterator last, Scratch scratch, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		static void mergeWithBuffer(Iterator first, Iterator middle, Iterator last, Item* buffer, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		static void mergeHigh(Iterator first1, Iterator last1, Item* bufferFirst, Item* bufferLast, Iterator destinationLast, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		static void mergeLow(Item* bufferFirst, Item* bufferLast, Iterator first2, Iterator last2, Iterator destination, CompareFn lessThan);
+		template <typename Iterator, typename T, typename CompareFn>
+		static Iterator gallop(Iterator first, Iterator last, const T& value, CompareFn lessThan);
+
+		template <typename Iterator, typename CompareFn>
+		static void sortLeaf(Iterator first, Iterator last, CompareFn lessThan);
+		template <typename Iterator, typename CompareFn>
+		void sortWithBuffer(Iterator first, Iterator last, Scratch scratch, CompareFn lessThan);
+		template <typename SourceIt, typename DestIt, typename CompareFn>
+		void sort(SourceIt first, SourceIt last, DestIt destination, bool intoDestination, CompareFn lessThan);
+		template <typename LowerPart, typename UpperPart>
+		void runInParallel(LowerPart lower, UpperPart upper);
+		template <typename InputIt, typename OutputIt, typename CompareFn>
+		void mergeHalves(InputIt first, InputIt middle, InputIt last, OutputIt destination, CompareFn lessThan);
+		template <typename InputIt, typename OutputIt, typename CompareFn>
+		void mergeInParallel(InputIt first1, InputIt last1, InputIt first2, InputIt last2, OutputIt destination, CompareFn lessThan);
+		template <typename InputIt, typename OutputIt, typename CompareFn>
+		static void merge(InputIt first1, InputIt last1, InputIt first2, InputIt last2, OutputIt destination, CompareFn lessThan);
 		template <typename CompareFn>
-		void merge(RandomAccessIt first, RandomAccessIt middle, RandomAccessIt last, CompareFn lessThan);
-		void init(RandomAccessIt first, RandomAccessIt middle, RandomAccessIt last);
-		template <typename CompareFn>
-		void mergeInBuffer(CompareFn lessThan);
-		void insertFromLeftPart();
-		void insertFromRightPart();
-		void insertFrom(Difference& partIndex);
-		void moveResultBack();
-		void clear() noexcept;
+		static void mergeBranchless(const Item* first1, const Item* last1, 
+									const Item* first2, const Item* last2, 
+									Item* destination, 
+									CompareFn lessThan);
+		template <typename InputIt, typename OutputIt>
+		static OutputIt moveItems(InputIt first, InputIt last, OutputIt destination);
+		Buffer makeBuffer(std::size_t size) const;
+		Difference defaultGrain(Difference length) const;
+		ThreadPool& threadPool() const;
+
+	private:
+		ThreadPool* pool = nullptr;
+		std::size_t grain = parallelGrain;
+		std::size_t leafLength = std::max<std::size_t>(lowerBound, 1);
+		Difference sequentialCutoff = 0;
+		MergeStrategy strategy = MergeStrategy::balanced;
+		std::pmr::memory_resource* resource = nullptr;
+		std::size_t scratchLimit = std::numeric_limits<std::size_t>::max();
+		std::atomic<std::size_t> mergesCount = 0;
+		std::atomic<std::size_t> skippedMergesCount = 0;
+		std::atomic<std::size_t> rotationsCount = 0;
+	};
+
+	//a tournament over size players in which comesFirst(i, j) tells
+	//whether player i beats player j, after the winner changes 
+	//replay() finds the new one with log(size) matches
+	template <typename ComesFirst>
+	class LoserTree
+	{
+	public:
+		LoserTree(std::size_t size, ComesFirst comesFirst);
+
+		std::size_t winner() const noexcept;
+		void replay();
+
+	private:
+		std::vector<std::size_t> losers;
+		std::size_t top = 0;
+		ComesFirst comesFirst;
+	};
+
+	//merges the sorted ranges given as pairs of iterators in [firstRange, lastRange),
+	//equal items are taken in the order of their ranges
+	template <typename RangesIt, typename OutputIt, typename CompareFn = decltype(std::less{})>
+	OutputIt kWayMerge(RangesIt firstRange, RangesIt lastRange, OutputIt destination, CompareFn lessThan = {});
+
+	//argsort returns the permutation p such that first[p[0]], first[p[1]], ... is sorted,
+	//the items themselves are not moved. argsort and parallelArgsort keep
+	//equal items in their original order while unstableArgsort may not
+	template <typename Index = std::uint32_t, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	std::vector<Index> argsort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {});
+
+	template <typename Index = std::uint32_t, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	std::vector<Index> unstableArgsort(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan = {});
+
+	template <typename Index = std::uint32_t, typename RandomAccessIt, typename CompareFn = decltype(std::less{})>
+	std::vector<Index> parallelArgsort(RandomAccessIt first, RandomAccessIt last, ThreadPool& pool, CompareFn lessThan = {});
+
+	//moves first[permutation[i]] to first[i] for every i by following the cycles of the permutation
+	template <typename RandomAccessIt, typename Index>
+	void applyPermutation(RandomAccessIt first, std::vector<Index> permutation);
+
+	//times sorts of copies of the sample with one setting changed at a time
+	//and returns the fastest settings for items like it on this machine
+	template <typename Item, typename CompareFn = decltype(std::less{})>
+	MergeSorterTuning autotuneMergeSorter(const std::vector<Item>& sample, CompareFn lessThan = {}, ThreadPool& pool = ThreadPool::shared());
+
+	//a tuning file has a line per profile: "<profile> <leaf length> <parallel grain> <strategy>",
+	//profiles name the item type, comparator and machine and have no whitespace
+	void saveTuning(const std::filesystem::path& file, const std::string& profile, const MergeSorterTuning& tuning);
+	std::optional<MergeSorterTuning> loadTuning(const std::filesystem::path& file, const std::string& profile);
 
-		bool isLeftPartExhausted() const noexcept;
-		bool isRightPartExhausted() const noexcept;
+	struct ExternalSortProgress
+	{
+		std::uint64_t bytesRead = 0;
+		std::uint64_t bytesWritten = 0;
+		std::uint64_t runsCreated = 0;
+		std::uint64_t mergePasses = 0;
+		std::chrono::duration<double> elapsed{};
+	};
+
+	//sorts files of fixed-size records which may not fit in memory:
+	//sorted runs of at most memoryBudget bytes (scratch included) are written 
+	//to temporary files and then merged in passes of as many runs as the budget allows
+	template <typename Record>
+	class ExternalSorter
+	{
+	private:
+		static_assert(std::is_trivially_copyable_v<Record>, "Records are read and written as raw bytes");
+
+		using Clock = std::chrono::steady_clock;
+		using Counter = std::atomic<std::uint64_t>;
+		using File = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+		class TemporaryFile
+		{
+		public:
+			explicit TemporaryFile(std::filesystem::path path) noexcept;
+			TemporaryFile(TemporaryFile&& source) noexcept;
+			~TemporaryFile();
+
+			TemporaryFile& operator=(TemporaryFile&&) = delete;
+
+			const std::filesystem::path& path() const noexcept;
+
+		private:
+			std::filesystem::path filePath;
+		};
+
+		class RunReader
+		{
+		public:
+			RunReader(const std::filesystem::path& path, std::size_t blockSize, Counter& bytesRead);
+
+			bool isExhausted() const noexcept;
+			const Record& front() const noexcept;
+			void pop();
+
+		private:
+			void refill();
+
+		private:
+			File file;
+			std::vector<Record> block;
+			std::size_t position = 0;
+			std::size_t count = 0;
+			Counter* bytesRead;
+		};
+
+		class RunWriter
+		{
+		public:
+			RunWriter(const std::filesystem::path& path, std::size_t blockSize, Counter& bytesWritten);
+
+			void push(const Record& record);
+			void write(const Record* first, const Record* last);
+			void flush();
+			void close();
+
+		private:
+			File file;
+			std::vector<Record> block;
+			Counter* bytesWritten;
+		};
+
+	public:
+		explicit ExternalSorter(std::size_t memoryBudget,
+								std::filesystem::path temporaryDirectory = std::filesystem::temp_directory_path());
+
+		ExternalSorter(const ExternalSorter&) = delete;
+		ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+		template <typename CompareFn = decltype(std::less{})>
+		void operator()(const std::filesystem::path& input, const std::filesystem::path& output, CompareFn lessThan = {});
+
+		//safe to call from other threads while a sort is running
+		ExternalSortProgress getProgress() const noexcept;
+
+	private:
+		template <typename CompareFn>
+		std::vector<TemporaryFile> createRuns(const std::filesystem::path& input, const std::filesystem::path& output, CompareFn lessThan);
 		template <typename CompareFn>
-		bool rightPointsToSmallerItem(CompareFn lessThan) const;
+		void mergeRuns(const std::vector<TemporaryFile>& runs, std::size_t first, std::size_t last, const std::filesystem::path& output, CompareFn lessThan);
+		TemporaryFile makeTemporaryFile();
+		std::size_t maxFanIn() const noexcept;
+		void resetProgress();
+
+		static File open(const std::filesystem::path& path, const char* mode);
 
 	private:
-		RandomAccessIt first;
-		Difference left = 0;
-		Difference right = 0;
-		Difference middle = 0;
-		Difference length = 0;
-		Buffer buffer;
+		std::size_t memoryBudget;
+		std::filesystem::path temporaryDirectory;
+		std::uint64_t temporaryFilesCount = 0;
+		Counter bytesRead = 0;
+		Counter bytesWritten = 0;
+		Counter runsCreated = 0;
+		Counter mergePasses = 0;
+		std::atomic<Clock::rep> startTime = 0;
+		std::atomic<Clock::rep> finishTime = 0;
 	};
 
 	template <typename InputIt,
@@ -296,6 +1114,22 @@ namespace IDragnev::Algorithm
 	}
 }
 
+#include "ThreadPoolImpl.hpp"
 #include "SelectionSorterImpl.hpp"
 #include "InsertionSorterImpl.hpp"
+#include "HeapImpl.hpp"
+#include "DaryHeapImpl.hpp"
+#include "QuickSorterImpl.hpp"
+#include "NthElementImpl.hpp"
+#include "TopKImpl.hpp"
+#include "StaticSorterImpl.hpp"
+#include "RadixSorterImpl.hpp"
+#include "CountingSorterImpl.hpp"
+#include "StringSorterImpl.hpp"
+#include "SampleSorterImpl.hpp"
+#include "SortingNetworkImpl.hpp"
 #include "MergeSorterImpl.hpp"
+#include "KWayMergeImpl.hpp"
+#include "ArgsortImpl.hpp"
+#include "ExternalSorterImpl.hpp"
+#include "MergeSorterTuningImpl.hpp"
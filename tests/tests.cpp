@@ -3,7 +3,14 @@
 #include "algorithm.hpp"
 #include "functional.hpp"
 #include <vector>
+#include <deque>
 #include <numeric>
+#include <string>
+#include <algorithm>
+#include <memory_resource>
+#include <filesystem>
+#include <fstream>
+#include <ctime>
 
 namespace alg = IDragnev::Algorithm;
 
@@ -34,7 +41,9 @@ const auto find = [](const auto& range, auto value)
 	return find_if(range, [&value](const auto& x) { return x == value;});
 };
 
-TEST_CASE_TEMPLATE("sortings ", Sorter, alg::InsertionSorter, alg::SelectionSorter)
+using IntsMergeSorter = alg::MergeSorter<std::vector<int>::iterator>;
+
+TEST_CASE_TEMPLATE("sortings ", Sorter, alg::InsertionSorter, alg::SelectionSorter, alg::QuickSorter, alg::SampleSorter, IntsMergeSorter, alg::RadixSorter<>, alg::CountingSorter)
 {
 	const auto expected = iota(1, 100);
 	auto nums = reverse(expected);
@@ -44,6 +53,1198 @@ TEST_CASE_TEMPLATE("sortings ", Sorter, alg::InsertionSorter, alg::SelectionSort
 	CHECK(nums == expected);
 }
 
+TEST_CASE_TEMPLATE("sortings of empty ranges", Sorter, alg::InsertionSorter, alg::SelectionSorter, alg::QuickSorter, alg::SampleSorter, IntsMergeSorter, alg::RadixSorter<>, alg::CountingSorter)
+{
+	auto none = std::vector<int>{};
+	auto single = std::vector<int>{ 1 };
+
+	Sorter{}(std::begin(none), std::end(none));
+	Sorter{}(std::begin(single), std::end(single));
+
+	CHECK(none.empty());
+	CHECK(single == std::vector<int>{ 1 });
+}
+
+TEST_CASE("thread pool")
+{
+	SUBCASE("submitted tasks produce their results")
+	{
+		auto pool = alg::ThreadPool{ 2 };
+		auto result = pool.submit([]() { return 42; });
+
+		pool.wait(result);
+		CHECK(result.get() == 42);
+	}
+
+	SUBCASE("pool without workers runs tasks on the waiting thread")
+	{
+		auto pool = alg::ThreadPool{ 0 };
+		auto result = pool.submit([]() { return 42; });
+
+		pool.wait(result);
+		CHECK(pool.workersCount() == 0);
+		CHECK(result.get() == 42);
+	}
+
+	SUBCASE("waiting for a long task does not keep the waiting thread busy")
+	{
+		auto pool = alg::ThreadPool{ 1 };
+		auto started = std::promise<void>{};
+		auto result = pool.submit([&started]()
+		{
+			started.set_value();
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 300 });
+			return 42;
+		});
+		started.get_future().wait();
+
+		const auto cpuStart = std::clock();
+		pool.wait(result);
+		const auto cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+		CHECK(result.get() == 42);
+		CHECK(cpuSeconds < 0.1);
+	}
+}
+
+TEST_CASE("merge sorter with a custom thread pool")
+{
+	auto pool = alg::ThreadPool{ 2 };
+	const auto expected = iota(1, 1'000);
+
+	SUBCASE("reusing the pool across calls")
+	{
+		auto sorter = IntsMergeSorter{ pool };
+
+		for (auto i = 0; i < 2; ++i)
+		{
+			auto nums = reverse(expected);
+			sorter(std::begin(nums), std::end(nums));
+			CHECK(nums == expected);
+		}
+	}
+
+	SUBCASE("with a run time parallel grain")
+	{
+		auto sorter = IntsMergeSorter{ pool, 100 };
+		auto nums = reverse(expected);
+
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == expected);
+		CHECK(sorter.getParallelGrain() == 100);
+	}
+
+	SUBCASE("with a compile time parallel grain")
+	{
+		auto sorter = alg::MergeSorter<std::vector<int>::iterator, 25, 1'000>{ pool };
+		auto nums = reverse(expected);
+
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == expected);
+		CHECK(sorter.getParallelGrain() == 1'000);
+	}
+}
+
+TEST_CASE("merge sorter is stable with parallel merges")
+{
+	using Item = std::pair<int, int>;
+	using Items = std::vector<Item>;
+
+	auto items = Items{};
+	for (auto i = 0; i < 1'000; ++i)
+	{
+		items.emplace_back(i % 10, i);
+	}
+
+	auto expected = items;
+	std::stable_sort(std::begin(expected), std::end(expected), [](auto& x, auto& y) { return x.first < y.first; });
+
+	auto pool = alg::ThreadPool{ 2 };
+	auto sorter = alg::MergeSorter<Items::iterator>{ pool, 30 };
+	sorter(std::begin(items), std::end(items), [](auto& x, auto& y) { return x.first < y.first; });
+
+	CHECK(items == expected);
+}
+
+TEST_CASE("merge sorter statistics")
+{
+	auto sorter = IntsMergeSorter{};
+
+	SUBCASE("sorted halves are not merged")
+	{
+		auto nums = iota(1, 1'000);
+
+		sorter(std::begin(nums), std::end(nums));
+		const auto statistics = sorter.getStatistics();
+
+		CHECK(nums == iota(1, 1'000));
+		CHECK(statistics.merges == 0);
+		CHECK(statistics.skippedMerges > 0);
+	}
+
+	SUBCASE("swapped halves are rotated")
+	{
+		auto nums = reverse(iota(1, 1'000));
+
+		sorter(std::begin(nums), std::end(nums));
+		const auto statistics = sorter.getStatistics();
+
+		CHECK(nums == iota(1, 1'000));
+		CHECK(statistics.merges == 0);
+		CHECK(statistics.rotations > 0);
+	}
+
+	SUBCASE("reset")
+	{
+		auto nums = reverse(iota(1, 1'000));
+
+		sorter(std::begin(nums), std::end(nums));
+		sorter.resetStatistics();
+		const auto statistics = sorter.getStatistics();
+
+		CHECK(statistics.merges == 0);
+		CHECK(statistics.rotations == 0);
+		CHECK(statistics.skippedMerges == 0);
+	}
+}
+
+TEST_CASE("merge sorter takes scratch memory from its memory resource")
+{
+	using Resource = std::pmr::monotonic_buffer_resource;
+
+	static char memory[16 * 1'024];
+	auto resource = Resource{ memory, sizeof(memory), std::pmr::null_memory_resource() };
+	auto nums = reverse(iota(1, 1'000));
+
+	auto sorter = IntsMergeSorter{};
+	sorter.setMemoryResource(&resource);
+
+	SUBCASE("balanced")
+	{
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == iota(1, 1'000));
+	}
+
+	SUBCASE("natural")
+	{
+		sorter.setStrategy(alg::MergeStrategy::natural);
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == iota(1, 1'000));
+	}
+
+	CHECK(sorter.getMemoryResource() == &resource);
+}
+
+TEST_CASE("merge sorter with a bounded scratch limit")
+{
+	using Item = std::pair<int, int>;
+	using Items = std::vector<Item>;
+	using Sorter = alg::MergeSorter<Items::iterator>;
+
+	auto items = Items{};
+	for (auto i = 0; i < 2'000; ++i)
+	{
+		items.push_back({ (i * 7'919) % 13, i });
+	}
+	auto expected = items;
+	auto byKey = [](const Item& lhs, const Item& rhs) { return lhs.first < rhs.first; };
+	std::stable_sort(std::begin(expected), std::end(expected), byKey);
+
+	auto sorter = Sorter{};
+	CHECK(sorter.getScratchLimit() == std::numeric_limits<std::size_t>::max());
+
+	SUBCASE("without scratch memory")
+	{
+		sorter.setScratchLimit(0);
+		sorter(std::begin(items), std::end(items), byKey);
+		CHECK(items == expected);
+	}
+
+	SUBCASE("with a small scratch")
+	{
+		sorter.setScratchLimit(50);
+		sorter(std::begin(items), std::end(items), byKey);
+		CHECK(items == expected);
+	}
+
+	SUBCASE("with a small scratch and the natural strategy")
+	{
+		sorter.setScratchLimit(50);
+		sorter.setStrategy(alg::MergeStrategy::natural);
+		sorter(std::begin(items), std::end(items), byKey);
+		CHECK(items == expected);
+	}
+
+	SUBCASE("skewed merges of many items")
+	{
+		auto nums = iota(0, 999'999);
+		std::reverse(std::begin(nums) + 500'000, std::end(nums));
+		auto expected = nums;
+		std::sort(std::begin(expected), std::end(expected));
+
+		auto intsSorter = IntsMergeSorter{};
+		intsSorter.setScratchLimit(100);
+		intsSorter(std::begin(nums), std::end(nums));
+
+		CHECK(nums == expected);
+	}
+
+	SUBCASE("skewed merges of many items in a deque without scratch memory")
+	{
+		auto nums = std::deque<int>{};
+		for (auto i = 0; i < 200'000; ++i)
+		{
+			nums.push_back(i < 100'000 ? i : 200'000 - i);
+		}
+		auto expected = nums;
+		std::sort(std::begin(expected), std::end(expected));
+
+		auto dequeSorter = alg::MergeSorter<std::deque<int>::iterator>{};
+		dequeSorter.setScratchLimit(0);
+		dequeSorter(std::begin(nums), std::end(nums));
+
+		CHECK(nums == expected);
+	}
+
+	SUBCASE("the limit is copied")
+	{
+		sorter.setScratchLimit(10);
+		auto copy = sorter;
+		CHECK(copy.getScratchLimit() == 10);
+	}
+}
+
+TEST_CASE("merge sorter tuning")
+{
+	namespace fs = std::filesystem;
+
+	const auto file = fs::temp_directory_path() / "IDragnev-merge-sorter-tuning";
+	fs::remove(file);
+
+	SUBCASE("is applied to the sorter")
+	{
+		auto sorter = IntsMergeSorter{};
+		sorter.setTuning({ 8, 100, alg::MergeStrategy::natural });
+		const auto tuning = sorter.getTuning();
+
+		CHECK(tuning.leafLength == 8);
+		CHECK(tuning.parallelGrain == 100);
+		CHECK(tuning.strategy == alg::MergeStrategy::natural);
+
+		auto nums = reverse(iota(1, 1'000));
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == iota(1, 1'000));
+	}
+
+	SUBCASE("leaf length is at least one item")
+	{
+		auto sorter = IntsMergeSorter{};
+		sorter.setLeafLength(0);
+		auto nums = reverse(iota(1, 100));
+
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == iota(1, 100));
+		CHECK(sorter.getLeafLength() == 1);
+	}
+
+	SUBCASE("profiles are saved and loaded")
+	{
+		alg::saveTuning(file, "int-less", { 16, 0, alg::MergeStrategy::balanced });
+		alg::saveTuning(file, "string-less", { 8, 4'096, alg::MergeStrategy::natural });
+		alg::saveTuning(file, "int-less", { 32, 1'024, alg::MergeStrategy::balanced });
+
+		const auto ints = alg::loadTuning(file, "int-less");
+		const auto strings = alg::loadTuning(file, "string-less");
+
+		REQUIRE(ints.has_value());
+		REQUIRE(strings.has_value());
+		CHECK(ints->leafLength == 32);
+		CHECK(ints->parallelGrain == 1'024);
+		CHECK(strings->strategy == alg::MergeStrategy::natural);
+		CHECK(!alg::loadTuning(file, "double-less").has_value());
+		CHECK_THROWS_AS(alg::saveTuning(file, "with spaces", {}), std::invalid_argument);
+	}
+
+	SUBCASE("autotuning picks settings which sort the sample")
+	{
+		auto sample = reverse(iota(1, 2'000));
+		std::rotate(std::begin(sample), std::begin(sample) + 700, std::end(sample));
+
+		const auto tuning = alg::autotuneMergeSorter(sample);
+		auto sorter = IntsMergeSorter{};
+		sorter.setTuning(tuning);
+		sorter(std::begin(sample), std::end(sample));
+
+		CHECK(tuning.leafLength > 0);
+		CHECK(sample == iota(1, 2'000));
+	}
+
+	fs::remove(file);
+}
+
+TEST_CASE("merge sorter with the natural strategy")
+{
+	auto sorter = IntsMergeSorter{};
+	sorter.setStrategy(alg::MergeStrategy::natural);
+
+	SUBCASE("with ascending and descending runs")
+	{
+		auto nums = iota(1, 500);
+		std::reverse(std::begin(nums) + 100, std::begin(nums) + 300);
+		std::rotate(std::begin(nums), std::begin(nums) + 420, std::end(nums));
+
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == iota(1, 500));
+	}
+
+	SUBCASE("is stable")
+	{
+		using Item = std::pair<int, int>;
+		using Items = std::vector<Item>;
+
+		auto items = Items{};
+		for (auto i = 0; i < 1'000; ++i)
+		{
+			items.emplace_back((i * 7919) % 13, i);
+		}
+
+		auto expected = items;
+		const auto byKey = [](auto& x, auto& y) { return x.first < y.first; };
+		std::stable_sort(std::begin(expected), std::end(expected), byKey);
+
+		auto pairsSorter = alg::MergeSorter<Items::iterator>{};
+		pairsSorter.setStrategy(alg::MergeStrategy::natural);
+		pairsSorter(std::begin(items), std::end(items), byKey);
+
+		CHECK(items == expected);
+	}
+
+	SUBCASE("with a long run and one smaller item after it")
+	{
+		auto nums = iota(1, 1'000'000);
+		nums.push_back(0);
+
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == iota(0, 1'000'000));
+	}
+
+	SUBCASE("with a long run and one smaller item after it without scratch memory")
+	{
+		auto nums = iota(1, 1'000'000);
+		nums.push_back(0);
+
+		sorter.setScratchLimit(0);
+		sorter(std::begin(nums), std::end(nums));
+		CHECK(nums == iota(0, 1'000'000));
+	}
+}
+
+TEST_CASE_TEMPLATE("merge sorter with arithmetic keys", Key, int, unsigned, float, std::int64_t, double)
+{
+	using Keys = std::vector<Key>;
+	using Sorter = alg::MergeSorter<typename Keys::iterator>;
+
+	for (auto length : { 2, 7, 8, 9, 16, 25, 33, 64, 1'000 })
+	{
+		auto keys = Keys{};
+		for (auto i = 0; i < length; ++i)
+		{
+			keys.push_back(static_cast<Key>((i * 7'919) % 31));
+		}
+
+		auto ascending = keys;
+		auto descending = keys;
+		auto expectedAscending = keys;
+		auto expectedDescending = keys;
+		std::sort(std::begin(expectedAscending), std::end(expectedAscending));
+		std::sort(std::begin(expectedDescending), std::end(expectedDescending), std::greater<>{});
+
+		Sorter{}(std::begin(ascending), std::end(ascending), std::less<>{});
+		Sorter{}(std::begin(descending), std::end(descending), std::greater<Key>{});
+
+		CHECK(ascending == expectedAscending);
+		CHECK(descending == expectedDescending);
+	}
+}
+
+TEST_CASE("merge sorter with non-trivially copyable items")
+{
+	using Strings = std::vector<std::string>;
+	const auto expected = Strings{ "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", 
+								   "k", "l", "m", "n", "o", "p", "q", "r", "s", "t", 
+								   "u", "v", "w", "x", "y", "z" };
+	auto words = reverse(expected);
+
+	alg::MergeSorter<Strings::iterator, 4>{}(std::begin(words), std::end(words));
+	CHECK(words == expected);
+}
+
+TEST_CASE("argsort")
+{
+	using Indices = std::vector<std::uint32_t>;
+	using Words = std::vector<std::string>;
+
+	const auto words = Words{ "delta", "alpha", "charlie", "alpha", "bravo" };
+
+	SUBCASE("stable")
+	{
+		CHECK(alg::argsort(std::cbegin(words), std::cend(words)) == Indices{ 1, 3, 4, 2, 0 });
+	}
+
+	SUBCASE("parallel")
+	{
+		auto pool = alg::ThreadPool{ 2 };
+		CHECK(alg::parallelArgsort(std::cbegin(words), std::cend(words), pool) == Indices{ 1, 3, 4, 2, 0 });
+	}
+
+	SUBCASE("unstable with 64-bit indices")
+	{
+		const auto indices = alg::unstableArgsort<std::uint64_t>(std::cbegin(words), std::cend(words));
+		
+		auto sorted = Words{};
+		for (auto i : indices)
+		{
+			sorted.push_back(words[i]);
+		}
+
+		CHECK(sorted == Words{ "alpha", "alpha", "bravo", "charlie", "delta" });
+	}
+
+	SUBCASE("empty ranges")
+	{
+		const auto none = Words{};
+		auto pool = alg::ThreadPool{ 2 };
+
+		CHECK(alg::argsort(std::cbegin(none), std::cend(none)).empty());
+		CHECK(alg::parallelArgsort(std::cbegin(none), std::cend(none), pool).empty());
+		CHECK(alg::unstableArgsort(std::cbegin(none), std::cend(none)).empty());
+		CHECK(alg::argsort(std::cbegin(words), std::cbegin(words) + 1) == Indices{ 0 });
+	}
+
+	SUBCASE("applying the permutation")
+	{
+		auto copy = words;
+		alg::applyPermutation(std::begin(copy), alg::argsort(std::cbegin(copy), std::cend(copy)));
+
+		CHECK(copy == Words{ "alpha", "alpha", "bravo", "charlie", "delta" });
+	}
+}
+
+TEST_CASE("kWayMerge")
+{
+	using Item = std::pair<int, int>;
+	using Items = std::vector<Item>;
+	using Range = std::pair<Items::const_iterator, Items::const_iterator>;
+
+	const auto byKey = [](auto& x, auto& y) { return x.first < y.first; };
+	const auto mergeOf = [&byKey](std::size_t k)
+	{
+		auto inputs = std::vector<Items>(k);
+		for (auto i = 0; i < 300; ++i)
+		{
+			inputs[i % k].emplace_back(i % 17, i);
+		}
+
+		auto ranges = std::vector<Range>{};
+		auto expected = Items{};
+		for (auto& input : inputs)
+		{
+			std::stable_sort(std::begin(input), std::end(input), byKey);
+			ranges.emplace_back(std::cbegin(input), std::cend(input));
+			expected.insert(std::end(expected), std::cbegin(input), std::cend(input));
+		}
+		std::stable_sort(std::begin(expected), std::end(expected), byKey);
+
+		auto result = Items{};
+		alg::kWayMerge(std::cbegin(ranges), std::cend(ranges), std::back_inserter(result), byKey);
+
+		return std::make_pair(result, expected);
+	};
+
+	SUBCASE("with a few ranges")
+	{
+		const auto [result, expected] = mergeOf(3);
+		CHECK(result == expected);
+	}
+
+	SUBCASE("with many ranges")
+	{
+		const auto [result, expected] = mergeOf(13);
+		CHECK(result == expected);
+	}
+
+	SUBCASE("with ranges of different lengths")
+	{
+		for (auto k : { 2, 4, 9 })
+		{
+			auto inputs = std::vector<Items>(k);
+			for (auto i = 0; i < 500; ++i)
+			{
+				//the first range is left empty and the others get fewer items the later they are
+				auto range = 1 + (i * i) % (k - 1);
+				inputs[range].emplace_back(i % 7, i);
+			}
+
+			auto ranges = std::vector<Range>{};
+			auto expected = Items{};
+			for (auto& input : inputs)
+			{
+				std::stable_sort(std::begin(input), std::end(input), byKey);
+				ranges.emplace_back(std::cbegin(input), std::cend(input));
+				expected.insert(std::end(expected), std::cbegin(input), std::cend(input));
+			}
+			std::stable_sort(std::begin(expected), std::end(expected), byKey);
+
+			auto result = Items{};
+			alg::kWayMerge(std::cbegin(ranges), std::cend(ranges), std::back_inserter(result), byKey);
+
+			CHECK(result == expected);
+		}
+	}
+
+	SUBCASE("with items too big to cache")
+	{
+		using Strings = std::vector<std::string>;
+
+		auto inputs = std::vector<Strings>(6);
+		for (auto i = 0; i < 120; ++i)
+		{
+			inputs[i % 6].push_back(std::to_string(i % 10) + "-" + std::to_string(i));
+		}
+
+		auto ranges = std::vector<std::pair<Strings::const_iterator, Strings::const_iterator>>{};
+		auto expected = Strings{};
+		for (auto& input : inputs)
+		{
+			std::sort(std::begin(input), std::end(input));
+			ranges.emplace_back(std::cbegin(input), std::cend(input));
+			expected.insert(std::end(expected), std::cbegin(input), std::cend(input));
+		}
+		std::sort(std::begin(expected), std::end(expected));
+
+		auto result = Strings{};
+		alg::kWayMerge(std::cbegin(ranges), std::cend(ranges), std::back_inserter(result));
+
+		CHECK(result == expected);
+	}
+
+	SUBCASE("with no ranges")
+	{
+		const auto ranges = std::vector<Range>{};
+		auto result = Items{};
+
+		alg::kWayMerge(std::cbegin(ranges), std::cend(ranges), std::back_inserter(result));
+		CHECK(result.empty());
+	}
+}
+
+TEST_CASE("loser tree")
+{
+	SUBCASE("without players")
+	{
+		auto tree = alg::LoserTree{ 0, [](std::size_t, std::size_t) { return false; } };
+
+		CHECK(tree.winner() == 0);
+	}
+
+	SUBCASE("replaying after the winner changes")
+	{
+		auto scores = std::vector<int>{ 5, 3, 8, 1, 9 };
+		auto tree = alg::LoserTree{ scores.size(), [&scores](std::size_t i, std::size_t j) { return scores[i] < scores[j]; } };
+		CHECK(tree.winner() == 3);
+
+		scores[3] = 10;
+		tree.replay();
+		CHECK(tree.winner() == 1);
+	}
+}
+
+TEST_CASE("external sorter")
+{
+	namespace fs = std::filesystem;
+
+	struct Record
+	{
+		int key;
+		int id;
+
+		bool operator==(const Record& rhs) const { return key == rhs.key && id == rhs.id; }
+	};
+	using Records = std::vector<Record>;
+
+	const auto input = fs::temp_directory_path() / "IDragnev-external-sorter-input";
+	const auto output = fs::temp_directory_path() / "IDragnev-external-sorter-output";
+	const auto byKey = [](auto& x, auto& y) { return x.key < y.key; };
+
+	auto records = Records{};
+	for (auto i = 0; i < 10'000; ++i)
+	{
+		records.push_back({ (i * 7919) % 101, i });
+	}
+	{
+		auto file = std::ofstream{ input, std::ios::binary };
+		file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+	}
+
+	auto expected = records;
+	std::stable_sort(std::begin(expected), std::end(expected), byKey);
+
+	const auto readOutput = [&output]()
+	{
+		auto result = Records(fs::file_size(output) / sizeof(Record));
+		auto file = std::ifstream{ output, std::ios::binary };
+		file.read(reinterpret_cast<char*>(result.data()), result.size() * sizeof(Record));
+		return result;
+	};
+
+	SUBCASE("with input fitting in memory")
+	{
+		auto sorter = alg::ExternalSorter<Record>{ 1 << 20 };
+		sorter(input, output, byKey);
+
+		CHECK(readOutput() == expected);
+		CHECK(sorter.getProgress().runsCreated == 0);
+	}
+
+	SUBCASE("with several merge passes")
+	{
+		auto sorter = alg::ExternalSorter<Record>{ 256 * sizeof(Record) };
+		sorter(input, output, byKey);
+		const auto progress = sorter.getProgress();
+
+		CHECK(readOutput() == expected);
+		CHECK(progress.runsCreated > 2);
+		CHECK(progress.mergePasses > 1);
+		CHECK(progress.bytesWritten > progress.bytesRead / 2);
+	}
+
+	SUBCASE("failing to write the output")
+	{
+		//writes to /dev/full succeed until they are flushed,
+		//so the output is kept within a single buffer of the stream
+		if (fs::exists("/dev/full"))
+		{
+			fs::resize_file(input, 64 * sizeof(Record));
+
+			auto sorter = alg::ExternalSorter<Record>{ 1 << 20 };
+			CHECK_THROWS_AS(sorter(input, "/dev/full", byKey), std::runtime_error);
+		}
+	}
+
+	fs::remove(input);
+	fs::remove(output);
+}
+
+constexpr auto staticallySorted()
+{
+	auto nums = std::array<int, 5>{ 5, 1, 4, 2, 3 };
+	alg::staticSort(nums);
+
+	return nums;
+}
+
+static_assert(staticallySorted()[0] == 1 && staticallySorted()[4] == 5);
+
+//a network sorts all inputs if it sorts all inputs of zeros and ones
+const auto sortsZerosAndOnes = [](auto items)
+{
+	const auto count = items.size();
+
+	for (auto mask = 0u; mask < (1u << count); ++mask)
+	{
+		for (auto i = std::size_t{ 0 }; i < count; ++i)
+		{
+			items[i] = (mask >> i) & 1;
+		}
+
+		alg::staticSort(items);
+
+		if (!std::is_sorted(std::begin(items), std::end(items)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+};
+
+TEST_CASE("static sorter")
+{
+	CHECK(sortsZerosAndOnes(std::array<int, 1>{}));
+	CHECK(sortsZerosAndOnes(std::array<int, 3>{}));
+	CHECK(sortsZerosAndOnes(std::array<int, 8>{}));
+	CHECK(sortsZerosAndOnes(std::array<int, 13>{}));
+	CHECK(sortsZerosAndOnes(std::array<int, 16>{}));
+}
+
+TEST_CASE("static sorter with a comparator")
+{
+	auto nums = std::array<int, 8>{ 3, 8, 1, 7, 2, 6, 4, 5 };
+
+	alg::StaticSorter<8>{}(nums, std::greater<>{});
+
+	CHECK(nums == std::array<int, 8>{ 8, 7, 6, 5, 4, 3, 2, 1 });
+	CHECK(alg::StaticSorter<8>::comparatorsCount == 19);
+}
+
+struct CountingLeafSorter
+{
+	inline static auto calls = 0;
+
+	template <typename RandomAccessIt, typename CompareFn>
+	void operator()(RandomAccessIt first, RandomAccessIt last, CompareFn lessThan) const
+	{
+		++calls;
+		alg::InsertionSorter{}(first, last, lessThan);
+	}
+};
+
+TEST_CASE("merge sorter leaves")
+{
+	SUBCASE("zeros of different sign keep their order")
+	{
+		auto nums = std::vector<double>{};
+		for (auto i = 0; i < 1'000; ++i)
+		{
+			nums.push_back((i % 3 == 0) ? ((i % 2 == 0) ? -0.0 : 0.0) : (i * 7'919) % 101 - 50.0);
+		}
+		auto expected = nums;
+		std::stable_sort(std::begin(expected), std::end(expected));
+
+		alg::MergeSorter<std::vector<double>::iterator>{}(std::begin(nums), std::end(nums));
+
+		CHECK(std::equal(std::begin(nums), std::end(nums), std::begin(expected), [](double x, double y)
+		{
+			return x == y && std::signbit(x) == std::signbit(y);
+		}));
+	}
+
+	SUBCASE("arithmetic keys are sorted by the network")
+	{
+		namespace network = alg::Detail::SortingNetwork;
+
+		const auto sortsByNetwork = [](auto key)
+		{
+			using Key = decltype(key);
+
+			auto keys = std::vector<Key>{};
+			for (auto i = 0; i < 32; ++i)
+			{
+				keys.push_back(static_cast<Key>((i * 7'919) % 31));
+			}
+
+			return network::sort(keys.data(), keys.size(), false) && std::is_sorted(std::begin(keys), std::end(keys));
+		};
+
+		if (network::isAvailable())
+		{
+			CHECK(sortsByNetwork(0));
+			CHECK(sortsByNetwork(std::int64_t{ 0 }));
+			CHECK(sortsByNetwork(0.0f));
+			CHECK(sortsByNetwork(0.0));
+		}
+
+		auto zeros = std::vector<double>{ 0.0, -0.0, 1.0 };
+		CHECK_FALSE(network::sort(zeros.data(), zeros.size(), false));
+	}
+
+	SUBCASE("the chosen leaf sorter is used")
+	{
+		auto nums = reverse(iota(1, 1'000));
+		alg::MergeSorter<std::vector<int>::iterator, 16, 0, CountingLeafSorter>{}(std::begin(nums), std::end(nums));
+
+		CHECK(nums == iota(1, 1'000));
+		CHECK(CountingLeafSorter::calls > 0);
+	}
+}
+
+TEST_CASE("merge sorter with network leaves")
+{
+	auto sorter = alg::MergeSorter<std::vector<int>::iterator, 16, 0, alg::NetworkSorter<16>>{};
+	auto nums = reverse(iota(1, 1'000));
+	std::rotate(std::begin(nums), std::begin(nums) + 333, std::end(nums));
+
+	sorter(std::begin(nums), std::end(nums), [](int x, int y) { return x < y; });
+
+	CHECK(nums == iota(1, 1'000));
+}
+
+TEST_CASE("quick sorter")
+{
+	SUBCASE("patterned inputs")
+	{
+		const auto length = 5'000;
+		auto inputs = std::vector<std::vector<int>>(5, std::vector<int>(length));
+		for (auto i = 0; i < length; ++i)
+		{
+			inputs[0][i] = i;
+			inputs[1][i] = length - i;
+			inputs[2][i] = i % 3;
+			inputs[3][i] = (i < length / 2) ? i : length - i;
+			inputs[4][i] = (i * 7'919) % length;
+		}
+
+		for (auto& nums : inputs)
+		{
+			auto expected = nums;
+			std::sort(std::begin(expected), std::end(expected));
+
+			alg::QuickSorter{}(std::begin(nums), std::end(nums));
+
+			CHECK(nums == expected);
+		}
+	}
+
+	SUBCASE("with a comparator")
+	{
+		auto words = std::vector<std::string>{};
+		for (auto i = 0; i < 1'000; ++i)
+		{
+			words.push_back(std::to_string((i * 7'919) % 211));
+		}
+		auto expected = words;
+		std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+
+		alg::QuickSorter{}(std::begin(words), std::end(words), std::greater<>{});
+
+		CHECK(words == expected);
+	}
+}
+
+TEST_CASE("sample sorter")
+{
+	auto pool = alg::ThreadPool{ 3 };
+	auto sorter = alg::SampleSorter{ pool, 4 };
+
+	SUBCASE("many duplicates")
+	{
+		auto nums = std::vector<int>{};
+		for (auto i = 0; i < 300'000; ++i)
+		{
+			nums.push_back(static_cast<int>((i * 7'919ll) % 1'000 / 3));
+		}
+		auto expected = nums;
+		std::sort(std::begin(expected), std::end(expected));
+
+		sorter(std::begin(nums), std::end(nums));
+
+		CHECK(nums == expected);
+	}
+
+	SUBCASE("with a comparator")
+	{
+		auto words = std::vector<std::string>{};
+		for (auto i = 0; i < 50'000; ++i)
+		{
+			words.push_back(std::to_string((i * 7'919) % 50'021));
+		}
+		auto expected = words;
+		std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+
+		sorter(std::begin(words), std::end(words), std::greater<>{});
+
+		CHECK(words == expected);
+	}
+}
+
+TEST_CASE("radix sorter")
+{
+	SUBCASE("signed keys")
+	{
+		auto nums = std::vector<std::int64_t>{};
+		for (auto i = -500; i < 500; ++i)
+		{
+			nums.push_back((i * 7'919) % 1'000 * 1'000'003);
+		}
+		auto expected = nums;
+		std::sort(std::begin(expected), std::end(expected));
+
+		alg::RadixSorter<11>{}(std::begin(nums), std::end(nums));
+
+		CHECK(nums == expected);
+	}
+
+	SUBCASE("floating point keys")
+	{
+		auto nums = std::vector<double>{};
+		for (auto i = -500; i < 500; ++i)
+		{
+			nums.push_back((i * 7'919) % 1'000 / 3.0);
+		}
+		nums.push_back(std::numeric_limits<double>::infinity());
+		nums.push_back(-std::numeric_limits<double>::infinity());
+		auto expected = nums;
+		std::sort(std::begin(expected), std::end(expected));
+
+		alg::RadixSorter<>{}(std::begin(nums), std::end(nums));
+
+		CHECK(nums == expected);
+	}
+
+	SUBCASE("records by a key are sorted stably")
+	{
+		using Item = std::pair<std::string, std::uint32_t>;
+		using Items = std::vector<Item>;
+
+		auto items = Items{};
+		for (auto i = 0u; i < 1'000; ++i)
+		{
+			items.emplace_back(std::to_string(i), (i * 7'919) % 13);
+		}
+		auto expected = items;
+		std::stable_sort(std::begin(expected), std::end(expected), [](auto& x, auto& y) { return x.second < y.second; });
+
+		alg::RadixSorter<>{}(std::begin(items), std::end(items), [](const Item& item) { return item.second; });
+
+		CHECK(items == expected);
+	}
+
+	SUBCASE("in parallel")
+	{
+		using Item = std::pair<std::int64_t, std::uint32_t>;
+		using Items = std::vector<Item>;
+
+		auto items = Items{};
+		for (auto i = 0u; i < 300'000; ++i)
+		{
+			items.emplace_back((i * 7'919ll) % 100'003 - 50'000, i);
+		}
+		auto expected = items;
+		std::stable_sort(std::begin(expected), std::end(expected), [](auto& x, auto& y) { return x.first < y.first; });
+
+		auto pool = alg::ThreadPool{ 3 };
+		auto sorter = alg::RadixSorter<>{ pool, 4 };
+		sorter(std::begin(items), std::end(items), [](const Item& item) { return item.first; });
+
+		CHECK(items == expected);
+	}
+}
+
+struct LiveItem
+{
+	inline static auto alive = 0;
+
+	LiveItem() noexcept { ++alive; }
+	LiveItem(const LiveItem& source) noexcept : key(source.key) { ++alive; }
+	LiveItem& operator=(const LiveItem&) noexcept = default;
+	~LiveItem() { --alive; }
+
+	int key = 0;
+};
+
+TEST_CASE("counting sorter")
+{
+	using Item = std::pair<std::string, int>;
+	using Items = std::vector<Item>;
+
+	const auto keyOf = [](const Item& item) { return item.second; };
+	const auto stableSorted = [](Items items)
+	{
+		std::stable_sort(std::begin(items), std::end(items), [](auto& x, auto& y) { return x.second < y.second; });
+		return items;
+	};
+
+	auto items = Items{};
+	for (auto i = 0; i < 1'000; ++i)
+	{
+		items.emplace_back(std::to_string(i), (i * 7'919) % 13 - 6);
+	}
+	const auto expected = stableSorted(items);
+
+	SUBCASE("records by a key are sorted stably")
+	{
+		alg::CountingSorter{}(std::begin(items), std::end(items), keyOf);
+
+		CHECK(items == expected);
+	}
+
+	SUBCASE("with a given range of keys")
+	{
+		alg::CountingSorter{}(std::begin(items), std::end(items), keyOf, -10, 10);
+
+		CHECK(items == expected);
+	}
+
+	SUBCASE("keys out of the given range leave the items as they are")
+	{
+		const auto original = items;
+
+		CHECK_THROWS_AS(alg::CountingSorter{}(std::begin(items), std::end(items), keyOf, 0, 10), std::out_of_range);
+		CHECK(items == original);
+	}
+
+	SUBCASE("keys out of a given range too wide to count")
+	{
+		const auto original = items;
+
+		REQUIRE_FALSE(alg::CountingSorter::isSuitable(items.size(), 0, 1'000'000));
+		CHECK_THROWS_AS(alg::CountingSorter{}(std::begin(items), std::end(items), keyOf, 0, 1'000'000), std::out_of_range);
+		CHECK(items == original);
+	}
+
+	SUBCASE("a key throwing while items are moved")
+	{
+		auto keyed = std::vector<LiveItem>(100);
+		for (auto i = 0; i < 100; ++i)
+		{
+			keyed[i].key = i % 10;
+		}
+		const auto alive = LiveItem::alive;
+
+		//counting and checking the first item take 101 keys
+		auto calls = 0;
+		const auto throwingKeyOf = [&calls](const LiveItem& item)
+		{
+			if (++calls > 150)
+			{
+				throw std::runtime_error{ "key" };
+			}
+
+			return item.key;
+		};
+
+		CHECK_THROWS_AS(alg::CountingSorter{}(std::begin(keyed), std::end(keyed), throwingKeyOf, 0, 9), std::runtime_error);
+		CHECK(LiveItem::alive == alive);
+	}
+
+	SUBCASE("enumeration keys")
+	{
+		enum class Status : std::uint8_t { ok, pending, failed };
+
+		auto statuses = std::vector<Status>{};
+		for (auto i = 0; i < 300; ++i)
+		{
+			statuses.push_back(static_cast<Status>((i * 7'919) % 3));
+		}
+		auto expected = statuses;
+		std::sort(std::begin(expected), std::end(expected));
+
+		alg::CountingSorter{}(std::begin(statuses), std::end(statuses));
+
+		CHECK(statuses == expected);
+	}
+
+	SUBCASE("suitability")
+	{
+		CHECK(alg::CountingSorter::isSuitable(1'000, -6, 6));
+		CHECK(alg::CountingSorter::isSuitable(1'000'000, 0, 1'023));
+		CHECK_FALSE(alg::CountingSorter::isSuitable(100, 0, 1'023));
+		CHECK_FALSE(alg::CountingSorter::isSuitable(1'000'000, 0, 1'000'000));
+		CHECK_FALSE(alg::CountingSorter::isSuitable(1'000, 6, -6));
+		CHECK_FALSE(alg::CountingSorter::isSuitable<std::uint64_t>(4, 0, std::numeric_limits<std::uint64_t>::max()));
+		CHECK_FALSE(alg::CountingSorter::isSuitable(4, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()));
+	}
+
+	SUBCASE("keys over the full 64 bit range are sorted by radix")
+	{
+		constexpr auto highest = std::numeric_limits<std::uint64_t>::max();
+		constexpr auto signedLowest = std::numeric_limits<std::int64_t>::min();
+		constexpr auto signedHighest = std::numeric_limits<std::int64_t>::max();
+
+		auto unsignedNums = std::vector<std::uint64_t>{ 5, highest, 0, 3 };
+		alg::CountingSorter{}(std::begin(unsignedNums), std::end(unsignedNums));
+		CHECK(unsignedNums == std::vector<std::uint64_t>{ 0, 3, 5, highest });
+
+		auto signedNums = std::vector<std::int64_t>{ signedHighest, 0, signedLowest, -1 };
+		alg::CountingSorter{}(std::begin(signedNums), std::end(signedNums));
+		CHECK(signedNums == std::vector<std::int64_t>{ signedLowest, -1, 0, signedHighest });
+	}
+
+	SUBCASE("keys spread too widely are sorted by radix")
+	{
+		auto nums = std::vector<std::int64_t>{};
+		for (auto i = -500; i < 500; ++i)
+		{
+			nums.push_back((i * 7'919) % 1'000 * 1'000'003);
+		}
+		auto expected = nums;
+		std::sort(std::begin(expected), std::end(expected));
+
+		alg::CountingSorter{}(std::begin(nums), std::end(nums));
+
+		CHECK(nums == expected);
+	}
+
+	SUBCASE("in parallel")
+	{
+		using Record = std::pair<std::uint16_t, std::uint32_t>;
+
+		auto records = std::vector<Record>{};
+		for (auto i = 0u; i < 300'000; ++i)
+		{
+			records.emplace_back(static_cast<std::uint16_t>((i * 7'919ull) % 1'024), i);
+		}
+		auto expected = records;
+		std::stable_sort(std::begin(expected), std::end(expected), [](auto& x, auto& y) { return x.first < y.first; });
+
+		auto pool = alg::ThreadPool{ 3 };
+		auto sorter = alg::CountingSorter{ pool, 4 };
+		sorter(std::begin(records), std::end(records), [](const Record& record) { return record.first; });
+
+		CHECK(records == expected);
+	}
+}
+
+TEST_CASE("string sorter")
+{
+	SUBCASE("keys with shared prefixes")
+	{
+		auto words = std::vector<std::string>{};
+		for (auto i = 0; i < 10'000; ++i)
+		{
+			auto word = std::string("https://example.com/") + std::to_string((i * 7'919) % 1'000);
+			word.append(static_cast<std::size_t>(i % 7), static_cast<char>(i % 3 == 0 ? '\xe9' : 'a'));
+			words.push_back(std::move(word));
+		}
+		words.push_back("");
+		words.push_back("https://");
+		auto expected = words;
+		std::sort(std::begin(expected), std::end(expected));
+
+		alg::StringSorter{}(std::begin(words), std::end(words));
+
+		CHECK(words == expected);
+	}
+
+	SUBCASE("keys with zero characters")
+	{
+		auto words = std::vector<std::string>{};
+		for (auto i = 0; i < 3'000; ++i)
+		{
+			auto word = std::string{};
+			for (auto digits = i; digits > 0; digits /= 3)
+			{
+				word.push_back("\0ab"[digits % 3]);
+			}
+			words.push_back(std::move(word));
+		}
+		auto expected = words;
+		std::sort(std::begin(expected), std::end(expected));
+
+		alg::StringSorter{}(std::begin(words), std::end(words));
+
+		CHECK(words == expected);
+	}
+
+	SUBCASE("records by a key")
+	{
+		using Item = std::pair<int, std::string>;
+		using Items = std::vector<Item>;
+
+		auto items = Items{};
+		for (auto i = 0; i < 1'000; ++i)
+		{
+			items.emplace_back(i, "/usr/lib/" + std::to_string((i * 7'919) % 1'000));
+		}
+		auto expected = items;
+		std::sort(std::begin(expected), std::end(expected), [](auto& x, auto& y) { return x.second < y.second; });
+
+		alg::StringSorter{}(std::begin(items), std::end(items), [](const Item& item) -> const std::string& { return item.second; });
+
+		CHECK(items == expected);
+	}
+}
+
 TEST_CASE("minElementPosition")
 {
 	using alg::minElementPosition;
@@ -67,6 +1268,251 @@ TEST_CASE("minElementPosition")
 	}
 }
 
+TEST_CASE("nthElement")
+{
+	auto nums = std::vector<int>{};
+	for (auto i = 0; i < 10'000; ++i)
+	{
+		nums.push_back((i * 7'919) % 10'007 / 2);
+	}
+	auto sorted = nums;
+	std::sort(std::begin(sorted), std::end(sorted));
+
+	for (auto n : { 0, 1, 5'000, 9'999 })
+	{
+		auto copy = nums;
+		const auto nth = std::begin(copy) + n;
+
+		alg::nthElement(std::begin(copy), nth, std::end(copy));
+
+		CHECK(*nth == sorted[n]);
+		CHECK(std::all_of(std::begin(copy), nth, [nth](int x) { return x <= *nth; }));
+		CHECK(std::all_of(nth, std::end(copy), [nth](int x) { return x >= *nth; }));
+	}
+}
+
+TEST_CASE("partialSort")
+{
+	auto nums = std::vector<int>{};
+	for (auto i = 0; i < 10'000; ++i)
+	{
+		nums.push_back((i * 7'919) % 10'007 / 2);
+	}
+	auto sorted = nums;
+	std::sort(std::begin(sorted), std::end(sorted), std::greater<>{});
+
+	for (auto count : { 0, 10, 5'000, 10'000 })
+	{
+		auto copy = nums;
+
+		alg::partialSort(std::begin(copy), std::begin(copy) + count, std::end(copy), std::greater<>{});
+
+		CHECK(std::equal(std::begin(copy), std::begin(copy) + count, std::begin(sorted)));
+	}
+}
+
+TEST_CASE("partialSortCopy")
+{
+	const auto words = std::vector<std::string>{ "delta", "alpha", "echo", "charlie", "bravo" };
+
+	SUBCASE("shorter destination")
+	{
+		auto result = std::vector<std::string>(3);
+
+		const auto end = alg::partialSortCopy(std::cbegin(words), std::cend(words), std::begin(result), std::end(result));
+
+		CHECK(end == std::end(result));
+		CHECK(result == std::vector<std::string>{ "alpha", "bravo", "charlie" });
+	}
+
+	SUBCASE("longer destination")
+	{
+		auto result = std::vector<std::string>(7);
+
+		const auto end = alg::partialSortCopy(std::cbegin(words), std::cend(words), std::begin(result), std::end(result));
+
+		CHECK(end == std::begin(result) + 5);
+		CHECK(std::vector<std::string>(std::begin(result), end) == std::vector<std::string>{ "alpha", "bravo", "charlie", "delta", "echo" });
+	}
+}
+
+TEST_CASE("TopK")
+{
+	using Top = alg::TopK<int, 10>;
+
+	auto nums = std::vector<int>{};
+	for (auto i = 0; i < 1'000; ++i)
+	{
+		nums.push_back((i * 7'919) % 1'009);
+	}
+	auto expected = nums;
+	std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+	expected.resize(10);
+
+	SUBCASE("pushing items")
+	{
+		auto top = Top{};
+		top.push(std::cbegin(nums), std::cend(nums));
+
+		CHECK(top.size() == 10);
+		CHECK(top.sorted() == expected);
+	}
+
+	SUBCASE("merging accumulators")
+	{
+		auto lower = Top{};
+		auto upper = Top{};
+		lower.push(std::cbegin(nums), std::cbegin(nums) + 500);
+		upper.push(std::cbegin(nums) + 500, std::cend(nums));
+
+		lower.merge(std::move(upper));
+
+		CHECK(std::move(lower).sorted() == expected);
+	}
+
+	SUBCASE("fewer items than k")
+	{
+		auto top = Top{};
+		top.push(3);
+		top.push(1);
+		top.push(2);
+
+		CHECK(top.sorted() == std::vector<int>{ 3, 2, 1 });
+	}
+}
+
+TEST_CASE_TEMPLATE("heap functions", Arity, std::integral_constant<std::size_t, 2>, std::integral_constant<std::size_t, 4>, std::integral_constant<std::size_t, 8>)
+{
+	constexpr auto arity = Arity::value;
+
+	auto nums = std::vector<int>{};
+	for (auto i = 0; i < 1'000; ++i)
+	{
+		nums.push_back((i * 7'919) % 1'009);
+	}
+	auto expected = nums;
+	std::sort(std::begin(expected), std::end(expected));
+
+	SUBCASE("making and popping a heap")
+	{
+		alg::makeHeap<arity>(std::begin(nums), std::end(nums));
+
+		for (auto last = std::end(nums); last != std::begin(nums); --last)
+		{
+			alg::popHeap<arity>(std::begin(nums), last);
+		}
+
+		CHECK(nums == expected);
+	}
+
+	SUBCASE("pushing items one by one")
+	{
+		for (auto last = std::begin(nums); last != std::end(nums); )
+		{
+			alg::pushHeap<arity>(std::begin(nums), ++last);
+			CHECK(*std::begin(nums) == *std::max_element(std::begin(nums), last));
+		}
+	}
+
+	SUBCASE("heap sort")
+	{
+		alg::heapSort<arity>(std::begin(nums), std::end(nums), std::greater<>{});
+
+		CHECK(std::is_sorted(std::begin(nums), std::end(nums), std::greater<>{}));
+	}
+}
+
+TEST_CASE("DaryHeap")
+{
+	using Heap = alg::DaryHeap<int, 4>;
+
+	auto nums = std::vector<int>{};
+	for (auto i = 0; i < 1'000; ++i)
+	{
+		nums.push_back((i * 7'919) % 1'009);
+	}
+	auto expected = nums;
+	std::sort(std::begin(expected), std::end(expected), std::greater<>{});
+
+	SUBCASE("pushing and popping items")
+	{
+		auto heap = Heap{};
+		for (auto num : nums)
+		{
+			heap.push(num);
+		}
+
+		auto result = std::vector<int>{};
+		while (!heap.isEmpty())
+		{
+			result.push_back(heap.pop());
+		}
+
+		CHECK(result == expected);
+	}
+
+	SUBCASE("batches")
+	{
+		auto heap = Heap{ std::cbegin(nums), std::cbegin(nums) + 900 };
+		heap.pushBatch(std::cbegin(nums) + 900, std::cend(nums));
+
+		auto result = std::vector<int>{};
+		heap.popBatch(10, std::back_inserter(result));
+		CHECK(heap.size() == 990);
+
+		heap.popBatch(2'000, std::back_inserter(result));
+		CHECK(heap.isEmpty());
+		CHECK(result == expected);
+	}
+
+	SUBCASE("children start at a cache line")
+	{
+		auto heap = alg::DaryHeap<std::int64_t, 8>{ std::cbegin(nums), std::cend(nums) };
+
+		CHECK(reinterpret_cast<std::uintptr_t>(&heap.top() + 1) % 64 == 0);
+	}
+
+	SUBCASE("copies are independent")
+	{
+		auto heap = alg::DaryHeap<std::string, 8>{};
+		heap.push("b");
+		heap.push("c");
+
+		auto copy = heap;
+		copy.push("a");
+		copy.push(copy.top());
+
+		CHECK(heap.size() == 2);
+		CHECK(heap.pop() == "c");
+		CHECK(copy.size() == 4);
+		CHECK(copy.pop() == "c");
+		CHECK(copy.pop() == "c");
+	}
+
+	SUBCASE("with a lambda comparator")
+	{
+		const auto greaterThan = [](int x, int y) { return x > y; };
+		auto heap = alg::DaryHeap<int, 4, decltype(greaterThan)>{ greaterThan };
+		heap.push(2);
+		heap.push(1);
+
+		auto other = alg::DaryHeap<int, 4, decltype(greaterThan)>{ greaterThan };
+		other = heap;
+		heap = std::move(other);
+
+		CHECK(heap.pop() == 1);
+		CHECK(heap.pop() == 2);
+	}
+
+	SUBCASE("more items than memory can hold")
+	{
+		auto heap = Heap{};
+
+		CHECK_THROWS_AS(heap.reserve(std::numeric_limits<std::size_t>::max()), std::length_error);
+		CHECK_THROWS_AS(heap.reserve(std::numeric_limits<std::size_t>::max() / sizeof(int)), std::length_error);
+	}
+}
+
 TEST_CASE("lower bound")
 {
 	SUBCASE("with present key")